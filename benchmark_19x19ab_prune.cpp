@@ -22,7 +22,7 @@ int main() {
     test_network.initialize_random();
 
     // Value of best move
-    double best_move_value, temp_best_move_value = 0;
+    double best_move_value = 0;
 
     // Start timing for ab prune
     start = std::chrono::system_clock::now();
@@ -32,21 +32,42 @@ int main() {
     best_move_value = -std::numeric_limits<double>::infinity();
 
     std::vector<GoMove> move_list = test_game.get_move_list();
-    // For each possible move, calculate Alpha Beta
-    #pragma omp parallel for firstprivate(test_network)
-    for (unsigned int i = 0; i < move_list.size(); i++) {
-        GoGame temp_game(test_game);
-        temp_game.make_move(move_list[i], 0);
-
-        temp_best_move_value = scalable_go_ab_prune(test_network, temp_game, 0,
-                                                    -std::numeric_limits<double>::infinity(),
-                                                    std::numeric_limits<double>::infinity(), 1, false, 0);
-
-        if (temp_best_move_value > best_move_value) {
-            best_move_value = temp_best_move_value;
-            best_move = move_list[i];
+    // Index of the best move. Ties go to the earliest move, so the result does not depend on the thread count.
+    size_t best_move_index = 0;
+
+    // For each possible move, calculate Alpha Beta. Each thread keeps its own best, and the bests are combined at
+    // the end, so the shared best is never raced on.
+    #pragma omp parallel firstprivate(test_network)
+    {
+        double thread_best_value = -std::numeric_limits<double>::infinity();
+        size_t thread_best_index = 0;
+
+        #pragma omp for nowait
+        for (unsigned int i = 0; i < move_list.size(); i++) {
+            GoGame temp_game(test_game);
+            temp_game.make_move(move_list[i], 0);
+
+            double temp_best_move_value = -scalable_go_ab_prune(test_network, temp_game, 0,
+                                                                -std::numeric_limits<double>::infinity(),
+                                                                std::numeric_limits<double>::infinity(), 1, 0);
+
+            if (temp_best_move_value > thread_best_value) {
+                thread_best_value = temp_best_move_value;
+                thread_best_index = i;
+            }
+        }
+
+        #pragma omp critical
+        {
+            if ((thread_best_value > best_move_value) ||
+                ((thread_best_value == best_move_value) && (thread_best_index < best_move_index))) {
+                best_move_value = thread_best_value;
+                best_move_index = thread_best_index;
+            }
         }
     }
+    best_move = move_list[best_move_index];
+
     // Make Black Move
     test_game.make_move(best_move, 0);
 
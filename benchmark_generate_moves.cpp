@@ -0,0 +1,150 @@
+// Copyright [2016] <duncan@wduncanfraser.com>
+// Performance and heap allocation test for move generation and scoring
+
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <random>
+#include <atomic>
+#include <new>
+#include <cstdlib>
+
+#include "gogame.h"
+
+#define BOARD_SIZE 9;
+#define ITERATIONS 10000;
+#define OPENING_MOVES 30
+
+class BenchmarkArgumentError : public std::runtime_error {
+ public:
+    BenchmarkArgumentError() : std::runtime_error("BenchmarkArgumentError") { }
+};
+
+// Count of heap allocations made through operator new
+static std::atomic<uint64_t> allocation_count(0);
+
+void *operator new(std::size_t size) {
+    allocation_count++;
+    void *result = std::malloc(size ? size : 1);
+    if (!result) {
+        throw std::bad_alloc();
+    }
+    return result;
+}
+
+void operator delete(void *pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+// Function to run function for iterations, printing elapsed time and allocations per call
+template <typename Function>
+void run_benchmark(const char *name, const uint32_t iterations, Function function) {
+    uint64_t start_count = allocation_count;
+    std::chrono::time_point<std::chrono::system_clock> start, end;
+    start = std::chrono::system_clock::now();
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        function(i);
+    }
+
+    end = std::chrono::system_clock::now();
+    std::chrono::duration<double> elapsed_seconds = end - start;
+    std::cout << name << ": " << elapsed_seconds.count() << "s, "
+              << double(allocation_count - start_count) / iterations << " allocations per call\n";
+}
+
+int main(int argc, char* argv[]) {
+    uint8_t board_size = 0;
+    uint32_t iterations = 0;
+
+    // Validate command line parameters
+    if (argc == 1) {
+        // No parameters, use the Macros
+        board_size = BOARD_SIZE;
+        iterations = ITERATIONS;
+    } else if (argc == 3) {
+        // TODO(wdfraser): Add some better error checking
+        board_size = uint8_t(atoi(argv[1]));
+        iterations = atoi(argv[2]);
+    } else {
+        throw BenchmarkArgumentError();
+    }
+
+    // Play a fixed random opening so the benchmarks run on a position with strings and territory
+    GoGame test_game(board_size);
+    std::mt19937 generator(2016);
+    bool color = 0;
+    for (unsigned int i = 0; i < OPENING_MOVES; i++) {
+        test_game.generate_moves(color);
+        std::vector<GoMove> move_list = test_game.get_move_list();
+        // Skip the pass at the end of the list where possible
+        std::uniform_int_distribution<size_t> distribution(0, move_list.size() > 1 ? move_list.size() - 2 : 0);
+        test_game.make_move(move_list[distribution(generator)], color);
+        color = !color;
+    }
+    std::cout << "Board size " << int(board_size) << ", " << OPENING_MOVES << " opening moves, "
+              << iterations << " iterations\n";
+
+    // Alternate colors so the cached move list is regenerated on every call
+    run_benchmark("generate_moves", iterations, [&test_game](const uint32_t i) {
+        test_game.generate_moves(i & 1);
+    });
+
+    // Make and take back every move, as the AB search does at each node
+    test_game.generate_moves(color);
+    const std::vector<GoMove> play_list = test_game.get_move_list();
+    run_benchmark("play and undo (all moves)", iterations, [&test_game, &play_list, color](const uint32_t) {
+        for (const GoMove &element : play_list) {
+            test_game.play(element, color);
+            test_game.undo();
+        }
+    });
+
+    run_benchmark("calculate_scores", iterations, [&test_game](const uint32_t) {
+        test_game.calculate_scores();
+    });
+
+    // Games are copied for every root move by benchmark_19x19ab_prune, and once per helper thread by GoSearch
+    run_benchmark("GoGame copy", iterations, [&test_game](const uint32_t) {
+        GoGame copy_game(test_game);
+    });
+
+    // The string table is copied with the game. Rebuilding it from the board instead costs a flood fill per string.
+    const GoStringTable test_strings(test_game.get_board().board);
+    run_benchmark("GoStringTable copy", iterations, [&test_strings](const uint32_t) {
+        GoStringTable copy_strings(test_strings);
+    });
+
+    run_benchmark("GoStringTable rebuild", iterations, [&test_game](const uint32_t) {
+        GoStringTable rebuilt_strings(test_game.get_board().board);
+    });
+
+    run_benchmark("GoGame copy and play", iterations, [&test_game](const uint32_t i) {
+        GoGame copy_game(test_game);
+        copy_game.generate_moves(i & 1);
+        copy_game.play(copy_game.get_move_list().front(), i & 1);
+    });
+
+    // Construct the string of every stone on the board
+    GoMove board_move(test_game.get_board());
+    std::vector<std::pair<XYCoordinate, bool>> stones;
+    for (uint8_t y = 0; y < board_size; y++) {
+        for (uint8_t x = 0; x < board_size; x++) {
+            uint8_t mask = test_game.get_board().board.get(x, y);
+            if (mask != 0) {
+                stones.push_back(std::make_pair(XYCoordinate(x, y), get_piece_bool(mask)));
+            }
+        }
+    }
+    run_benchmark("construct_string (all stones)", iterations, [&board_move, &stones, board_size](const uint32_t) {
+        for (const std::pair<XYCoordinate, bool> &element : stones) {
+            GoString test_string(board_size);
+            test_string.append_member(element.first);
+            board_move.construct_string(test_string, element.second);
+        }
+    });
+}
@@ -4,8 +4,13 @@
 #include <iostream>
 #include <chrono>
 #include <vector>
+#include <atomic>
+#include <new>
+#include <cstdlib>
 
 #include "gogamenn.h"
+#include "gogamennevaluator.h"
+#include "neuralnetkernels.h"
 
 #define BOARD_SIZE 9;
 #define ITERATIONS 1000000;
@@ -15,6 +20,26 @@ class BenchmarkArgumentError : public std::runtime_error {
     BenchmarkArgumentError() : std::runtime_error("BenchmarkArgumentError") { }
 };
 
+// Count of heap allocations made through operator new
+static std::atomic<uint64_t> allocation_count(0);
+
+void *operator new(std::size_t size) {
+    allocation_count++;
+    void *result = std::malloc(size ? size : 1);
+    if (!result) {
+        throw std::bad_alloc();
+    }
+    return result;
+}
+
+void operator delete(void *pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
 int main(int argc, char* argv[]) {
     uint8_t board_size = 0;
     uint32_t iterations = 0;
@@ -46,17 +71,70 @@ int main(int argc, char* argv[]) {
     std::cout << "Elapsed time initializing NeuralNet: " << elapsed_seconds.count() << "s\n";
 
 
-    // Start timing for feedforward
+    // Time a copy of the network, as made for each OpenMP thread. Copies share their weights.
+    start = std::chrono::system_clock::now();
+    {
+        GoGameNN copy(test1);
+        copy.feed_forward(test_game, 0);
+    }
+    end = std::chrono::system_clock::now();
+    elapsed_seconds = end - start;
+    std::cout << "Elapsed time copying GoGameNN: " << elapsed_seconds.count() << "s\n";
+
+    // Time feedforward with every kernel the CPU supports
+    for (NeuralNetKernel kernel : get_supported_kernels()) {
+        set_active_kernel(kernel);
+
+        // Start timing for feedforward
+        start = std::chrono::system_clock::now();
+        #pragma omp parallel for firstprivate(test1)
+        for (unsigned int i = 0; i < iterations; i++) {
+            test1.feed_forward(networks_translation, test_game.get_pieces_placed()[0],
+                               test_game.get_prisoner_count()[0], test_game.get_prisoner_count()[1]);
+        }
+        // End timing
+        end = std::chrono::system_clock::now();
+
+        elapsed_seconds = end - start;
+        std::cout << "Kernel: " << get_kernel_name(kernel) << std::endl;
+        std::cout << "Elapsed time evaluating " << iterations << " iterations: " << elapsed_seconds.count() << "s\n";
+        std::cout << "Iterations per second: " << iterations / elapsed_seconds.count() << std::endl;
+    }
+
+    // Time leaf evaluation straight from the game, through the flat translation. The first call grows scratch space.
+    test1.feed_forward(test_game, 0);
+    uint64_t start_count = allocation_count;
+    start = std::chrono::system_clock::now();
+    for (unsigned int i = 0; i < iterations; i++) {
+        test1.feed_forward(test_game, 0);
+    }
+    end = std::chrono::system_clock::now();
+
+    elapsed_seconds = end - start;
+    std::cout << "Flat translation from GoGame" << std::endl;
+    std::cout << "Elapsed time evaluating " << iterations << " iterations: " << elapsed_seconds.count() << "s\n";
+    std::cout << "Iterations per second: " << iterations / elapsed_seconds.count() << std::endl;
+    std::cout << "Allocations per call: " << double(allocation_count - start_count) / iterations << std::endl;
+
+    // Time incremental leaf evaluation of every first move in turn, with the best kernel. Moves near the center are
+    // covered by most of the large windows, moves near the edge by few.
+    set_active_kernel(get_supported_kernels().back());
+    GoGameNNEvaluator evaluator(test1, test_game, 0);
+    test_game.generate_moves(0);
+    std::vector<GoMove> move_list = test_game.get_move_list();
+
     start = std::chrono::system_clock::now();
-    #pragma omp parallel for firstprivate(test1)
     for (unsigned int i = 0; i < iterations; i++) {
-        test1.feed_forward(networks_translation, test_game.get_pieces_placed()[0], test_game.get_prisoner_count()[0],
-                           test_game.get_prisoner_count()[1]);
+        test_game.play(move_list[i % move_list.size()], 0);
+        evaluator.update();
+        evaluator.evaluate();
+        test_game.undo();
+        evaluator.rollback();
     }
-    // End timing
     end = std::chrono::system_clock::now();
 
     elapsed_seconds = end - start;
+    std::cout << "Incremental evaluator, one move" << std::endl;
     std::cout << "Elapsed time evaluating " << iterations << " iterations: " << elapsed_seconds.count() << "s\n";
     std::cout << "Iterations per second: " << iterations / elapsed_seconds.count() << std::endl;
 }
@@ -7,6 +7,7 @@
 #include <random>
 
 #include "neuralnet.h"
+#include "neuralnetkernels.h"
 
 #define LAYERS 4
 #define INPUT 32
@@ -39,16 +40,22 @@ int main() {
         element = distribution(generator);
     }
 
-    // Start timing for feedforward
-    start = std::chrono::system_clock::now();
-    #pragma omp parallel for firstprivate(test1)
-    for (int i = 0; i < 1000000; i++) {
-        test1.feed_forward(testInput);
+    // Time feedforward with every kernel the CPU supports
+    for (NeuralNetKernel kernel : get_supported_kernels()) {
+        set_active_kernel(kernel);
+
+        // Start timing for feedforward
+        start = std::chrono::system_clock::now();
+        #pragma omp parallel for firstprivate(test1)
+        for (int i = 0; i < 1000000; i++) {
+            test1.feed_forward(testInput);
+        }
+        // End timing
+        end = std::chrono::system_clock::now();
+
+        elapsed_seconds = end - start;
+        std::cout << "Kernel: " << get_kernel_name(kernel) << std::endl;
+        std::cout << "Elapsed time evaluating 1,000,000 iterations: " << elapsed_seconds.count() << "s\n";
+        std::cout << "Iterations per second: " << 1000000 / elapsed_seconds.count() << std::endl;
     }
-    // End timing
-    end = std::chrono::system_clock::now();
-
-    elapsed_seconds = end - start;
-    std::cout << "Elapsed time evaluating 1,000,000 iterations: " << elapsed_seconds.count() << "s\n";
-    std::cout << "Iterations per second: " << 1000000 / elapsed_seconds.count() << std::endl;
 }
@@ -0,0 +1,109 @@
+// Copyright [2016] <duncan@wduncanfraser.com>
+// Performance test for the iterative deepening search driver, against the root move loop used by the programs
+
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <random>
+#include <limits>
+#include <thread>
+
+#include "gogame.h"
+#include "gogameab.h"
+#include "gogamenn.h"
+#include "gosearch.h"
+
+#define MAX_DEPTH 4
+#define BOARD_SIZE 9
+
+class BenchmarkArgumentError : public std::runtime_error {
+ public:
+    BenchmarkArgumentError() : std::runtime_error("BenchmarkArgumentError") { }
+};
+
+int main(int argc, char* argv[]) {
+    int max_depth = 0;
+    uint8_t board_size = 0;
+    unsigned int thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+
+    // Validate command line parameters
+    if (argc == 1) {
+        // No parameters, use the Macros
+        max_depth = MAX_DEPTH;
+        board_size = BOARD_SIZE;
+    } else if ((argc == 3) || (argc == 4)) {
+        // TODO(wdfraser): Add some better error checking
+        max_depth = atoi(argv[1]);
+        board_size = uint8_t(atoi(argv[2]));
+        if (argc == 4) {
+            thread_count = unsigned(atoi(argv[3]));
+        }
+    } else {
+        throw BenchmarkArgumentError();
+    }
+
+    // Fill about a fifth of the board with a fixed random opening
+    GoGame test_game(board_size);
+    std::mt19937 generator(2016);
+    bool color = 0;
+    for (unsigned int i = 0; i < board_size * board_size / 5u; i++) {
+        test_game.generate_moves(color);
+        std::vector<GoMove> move_list = test_game.get_move_list();
+        // Skip the pass at the end of the list where possible
+        std::uniform_int_distribution<size_t> distribution(0, move_list.size() > 1 ? move_list.size() - 2 : 0);
+        test_game.make_move(move_list[distribution(generator)], color);
+        color = !color;
+    }
+
+    GoGameNN test_network(board_size, false);
+    test_network.initialize_random();
+
+    // Root move loop at depth 1, as in the training and comparison programs
+    std::chrono::time_point<std::chrono::steady_clock> start, end;
+    start = std::chrono::steady_clock::now();
+    double best_move_value = -std::numeric_limits<double>::infinity();
+    test_game.generate_moves(color);
+    for (const GoMove &element : test_game.get_move_list()) {
+        test_game.play(element, color);
+        best_move_value = std::max(best_move_value, -scalable_go_ab_prune(
+                test_network, test_game, 1, -std::numeric_limits<double>::infinity(),
+                std::numeric_limits<double>::infinity(), !color, color));
+        test_game.undo();
+    }
+    end = std::chrono::steady_clock::now();
+    std::chrono::duration<double> loop_seconds = end - start;
+    std::cout << int(board_size) << "x" << int(board_size) << " root move loop at depth 1 (2 ply): "
+              << loop_seconds.count() << "s, value " << best_move_value << "\n";
+
+    std::cout << std::setw(8) << "Depth" << std::setw(12) << "Time (s)" << std::setw(12) << "Nodes"
+              << std::setw(12) << "Value" << std::setw(10) << "PV" << std::setw(10) << "Cutoffs"
+              << std::setw(12) << "First move" << std::setw(12) << "Researches" << std::endl;
+    for (int depth = 1; depth <= max_depth; depth++) {
+        GoSearch search(test_network);
+        GoSearchResult result = search.search(test_game, color, GoSearchLimits(depth));
+        std::cout << std::setw(8) << result.depth << std::setw(12) << std::fixed << std::setprecision(3)
+                  << result.elapsed << std::setw(12) << result.nodes << std::setw(12) << std::setprecision(6)
+                  << result.value << std::setw(10) << result.principal_variation.size() << std::setw(10)
+                  << result.cutoffs << std::setw(12) << std::setprecision(3) << result.get_first_move_rate()
+                  << std::setw(12) << result.researches << std::endl;
+    }
+
+    // Thread scaling at the deepest iteration
+    std::cout << std::setw(8) << "Threads" << std::setw(12) << "Time (s)" << std::setw(12) << "Nodes"
+              << std::setw(12) << "Value" << std::setw(10) << "Depth" << std::endl;
+    for (unsigned int threads = 1; threads <= thread_count; threads *= 2) {
+        GoSearch search(test_network, GOTT_DEFAULT_SIZE_MB, threads);
+        GoSearchResult result = search.search(test_game, color, GoSearchLimits(max_depth));
+        std::cout << std::setw(8) << threads << std::setw(12) << std::setprecision(3) << result.elapsed
+                  << std::setw(12) << result.nodes << std::setw(12) << std::setprecision(6) << result.value
+                  << std::setw(10) << result.depth << std::endl;
+    }
+
+    // Deepest search completed in the time of the root move loop
+    GoSearch search(test_network, GOTT_DEFAULT_SIZE_MB, thread_count);
+    GoSearchResult result = search.search(test_game, color, GoSearchLimits(board_size * board_size, 0,
+                                                                           loop_seconds.count()));
+    std::cout << "Deepest iteration completed in the same time: " << result.depth << std::endl;
+}
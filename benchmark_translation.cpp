@@ -0,0 +1,103 @@
+// Copyright [2016] <duncan@wduncanfraser.com>
+// Performance test for GoGameNN board translation, for every board size.
+// Every window is copied out of the board, so the translation length grows with the fourth power of the board size.
+// Values is that length, and the time per value shows how much of the flat time is the copying.
+// Evaluate is a full GoGameNN::feed_forward of the position, and Share the part of it spent on the flat translation.
+// Layer 1 does a multiply-add per hidden neuron for every translated value, so translation stays a small share.
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <random>
+#include <algorithm>
+
+#include "gogamenn.h"
+
+#define ITERATIONS 10000;
+// Evaluations are timed for this fraction of the iterations, as they are far slower than translations
+#define EVALUATION_DIVISOR 100
+
+class BenchmarkArgumentError : public std::runtime_error {
+ public:
+    BenchmarkArgumentError() : std::runtime_error("BenchmarkArgumentError") { }
+};
+
+// Sink for translation results, so the timed loops are not optimized away
+static volatile double benchmark_sink;
+
+// Function to run function for iterations, and return the time per call in nanoseconds
+template <typename Function>
+double run_benchmark(const uint32_t iterations, Function function) {
+    std::chrono::time_point<std::chrono::steady_clock> start, end;
+    start = std::chrono::steady_clock::now();
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        function(i);
+    }
+
+    end = std::chrono::steady_clock::now();
+    std::chrono::duration<double, std::nano> elapsed = end - start;
+    return elapsed.count() / iterations;
+}
+
+int main(int argc, char* argv[]) {
+    uint32_t iterations = 0;
+
+    // Validate command line parameters
+    if (argc == 1) {
+        // No parameters, use the Macros
+        iterations = ITERATIONS;
+    } else if (argc == 2) {
+        // TODO(wdfraser): Add some better error checking
+        iterations = atoi(argv[1]);
+    } else {
+        throw BenchmarkArgumentError();
+    }
+
+    std::cout << iterations << " iterations per board size, time per call\n";
+    std::cout << std::setw(6) << "Size" << std::setw(10) << "Windows" << std::setw(10) << "Values"
+              << std::setw(16) << "Nested (ns)" << std::setw(16) << "Flat (ns)" << std::setw(10) << "Speedup"
+              << std::setw(18) << "Flat (ns/value)" << std::setw(16) << "Evaluate (ns)" << std::setw(8) << "Share"
+              << std::endl;
+
+    for (uint8_t board_size = SEGMENT_MIN; board_size <= SEGMENT_MAX; board_size += SEGMENT_DIVISION) {
+        // Fill about a third of the board with a fixed random opening, so both colors are present
+        GoGame test_game(board_size);
+        std::mt19937 generator(2016);
+        bool color = 0;
+        for (unsigned int i = 0; i < board_size * board_size / 3u; i++) {
+            test_game.generate_moves(color);
+            std::vector<GoMove> move_list = test_game.get_move_list();
+            // Skip the pass at the end of the list where possible
+            std::uniform_int_distribution<size_t> distribution(0, move_list.size() > 1 ? move_list.size() - 2 : 0);
+            test_game.make_move(move_list[distribution(generator)], color);
+            color = !color;
+        }
+
+        const GoGameNNLayout &layout = get_go_network_layout(board_size);
+        NeuralNetBuffer<double> translation(layout.length);
+        GoGameNN test_network(board_size, false);
+        test_network.initialize_random();
+
+        double nested_time = run_benchmark(iterations, [&test_game](const uint32_t i) {
+            benchmark_sink = get_go_network_translation(test_game, i & 1).back()[0];
+        });
+        double flat_time = run_benchmark(iterations, [&test_game, &translation, &layout](const uint32_t i) {
+            get_go_network_translation(test_game, i & 1, translation.get());
+            benchmark_sink = translation.get()[layout.length - 1];
+        });
+        double evaluate_time = run_benchmark(std::max(iterations / EVALUATION_DIVISOR, 1u),
+                                             [&test_game, &test_network](const uint32_t i) {
+            test_network.feed_forward(test_game, i & 1);
+            benchmark_sink = test_network.get_output();
+        });
+
+        std::cout << std::setw(6) << int(board_size) << std::setw(10) << layout.window_offsets.size()
+                  << std::setw(10) << layout.length << std::setw(16) << std::fixed << std::setprecision(1)
+                  << nested_time << std::setw(16) << flat_time << std::setw(9) << std::setprecision(2)
+                  << nested_time / flat_time << "x" << std::setw(18) << std::setprecision(3)
+                  << flat_time / layout.length << std::setw(16) << std::setprecision(1) << evaluate_time
+                  << std::setw(7) << 100 * flat_time / evaluate_time << "%" << std::endl;
+    }
+}
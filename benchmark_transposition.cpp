@@ -0,0 +1,89 @@
+// Copyright [2016] <duncan@wduncanfraser.com>
+// Performance test for the AB search with a transposition table, for sizing the table for each board size
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <random>
+#include <limits>
+
+#include "gogame.h"
+#include "gogameab.h"
+#include "gogamenn.h"
+#include "gotranspositiontable.h"
+
+#define DEPTH 3
+#define BOARD_SIZE 5
+
+class BenchmarkArgumentError : public std::runtime_error {
+ public:
+    BenchmarkArgumentError() : std::runtime_error("BenchmarkArgumentError") { }
+};
+
+int main(int argc, char* argv[]) {
+    int depth = 0;
+    uint8_t board_size = 0;
+
+    // Validate command line parameters
+    if (argc == 1) {
+        // No parameters, use the Macros
+        depth = DEPTH;
+        board_size = BOARD_SIZE;
+    } else if (argc == 3) {
+        // TODO(wdfraser): Add some better error checking
+        depth = atoi(argv[1]);
+        board_size = uint8_t(atoi(argv[2]));
+    } else {
+        throw BenchmarkArgumentError();
+    }
+
+    // Fill about a fifth of the board with a fixed random opening
+    GoGame test_game(board_size);
+    std::mt19937 generator(2016);
+    bool color = 0;
+    for (unsigned int i = 0; i < board_size * board_size / 5u; i++) {
+        test_game.generate_moves(color);
+        std::vector<GoMove> move_list = test_game.get_move_list();
+        // Skip the pass at the end of the list where possible
+        std::uniform_int_distribution<size_t> distribution(0, move_list.size() > 1 ? move_list.size() - 2 : 0);
+        test_game.make_move(move_list[distribution(generator)], color);
+        color = !color;
+    }
+
+    GoGameNN test_network(board_size, false);
+    test_network.initialize_random();
+
+    std::chrono::time_point<std::chrono::steady_clock> start, end;
+    std::chrono::duration<double> elapsed_seconds;
+
+    start = std::chrono::steady_clock::now();
+    double expected = scalable_go_ab_prune(test_network, test_game, depth, -std::numeric_limits<double>::infinity(),
+                                           std::numeric_limits<double>::infinity(), color, color);
+    end = std::chrono::steady_clock::now();
+    elapsed_seconds = end - start;
+    std::cout << int(board_size) << "x" << int(board_size) << " search to depth " << depth << " without a table: "
+              << elapsed_seconds.count() << "s\n";
+
+    std::cout << std::setw(10) << "Size (MB)" << std::setw(12) << "Time (s)" << std::setw(12) << "Probes"
+              << std::setw(10) << "Hit rate" << std::setw(12) << "Stores" << std::setw(14) << "Replacements"
+              << std::setw(8) << "Match" << std::endl;
+
+    for (size_t size_mb = 1; size_mb <= 256; size_mb *= 4) {
+        GoTranspositionTable table(size_mb);
+        GoTranspositionStats stats;
+
+        start = std::chrono::steady_clock::now();
+        double value = scalable_go_ab_prune(test_network, test_game, depth, -std::numeric_limits<double>::infinity(),
+                                            std::numeric_limits<double>::infinity(), color, color, table,
+                                            &stats);
+        end = std::chrono::steady_clock::now();
+        elapsed_seconds = end - start;
+
+        std::cout << std::setw(10) << size_mb << std::setw(12) << std::fixed << std::setprecision(3)
+                  << elapsed_seconds.count() << std::setw(12) << stats.probes << std::setw(10)
+                  << std::setprecision(3) << stats.get_hit_rate() << std::setw(12) << stats.stores
+                  << std::setw(14) << stats.replacements << std::setw(8) << (value == expected ? "yes" : "no")
+                  << std::endl;
+    }
+}
@@ -0,0 +1,93 @@
+// Copyright [2016] <duncan@wduncanfraser.com>
+// Converter between the text and binary NeuralNet weight formats. The direction is detected from the input file.
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "neuralnet.h"
+#include "neuralnetfile.h"
+
+class ConvertArgumentError : public std::runtime_error {
+ public:
+    ConvertArgumentError() : std::runtime_error("ConvertArgumentError") { }
+};
+
+// Function to read the topology of the next network in a text weight file, leaving the file at its start.
+// Returns false at the end of the file.
+bool peek_text_topology(std::ifstream &file, std::vector<unsigned int> &neuron_counts) {
+    std::streampos start = file.tellg();
+    std::string line;
+    neuron_counts.clear();
+
+    // Skip blank lines between networks
+    do {
+        if (!getline(file, line, '\n')) {
+            return false;
+        }
+    } while (line.empty());
+    unsigned int layer_count = std::stoi(line);
+
+    getline(file, line, '\n');
+    std::istringstream layer_stream(line);
+    std::string line_element;
+    while (getline(layer_stream, line_element, ',')) {
+        neuron_counts.push_back(std::stoi(line_element));
+    }
+    if (neuron_counts.size() != layer_count) {
+        throw NeuralNetImportError();
+    }
+
+    file.clear();
+    file.seekg(start);
+    // Skip the blank lines again, so import_weights_stream starts at the layer count
+    while ((file.peek() == '\n') && file.ignore()) { }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cout << "Usage: convert_weights <input file> <output file>\n"
+                  << "Text weight files are converted to binary, and binary weight files to text.\n";
+        throw ConvertArgumentError();
+    }
+    std::string input_path = argv[1];
+    std::string output_path = argv[2];
+
+    size_t network_count = 0;
+    if (check_weight_file(input_path)) {
+        // Binary to text
+        std::shared_ptr<const NeuralNetWeightFile> input_file = std::make_shared<const NeuralNetWeightFile>(input_path);
+        std::ofstream output_file(output_path, std::ofstream::out | std::ofstream::trunc);
+
+        for (size_t index = 0; index < input_file->get_network_count(); ) {
+            const std::vector<unsigned int> &neuron_counts = input_file->get_neuron_counts(index);
+            NeuralNet network(unsigned(neuron_counts.size()), neuron_counts);
+            network.import_weights_binary(input_file, index);
+            network.export_weights_stream(output_file);
+            network_count++;
+        }
+        std::cout << "Converted " << network_count << " networks from binary to text.\n";
+    } else {
+        // Text to binary
+        std::ifstream input_file(input_path);
+        if (!input_file.is_open()) {
+            std::cout << "Input file failed to open.\n";
+            throw NeuralNetImportError();
+        }
+        NeuralNetWeightFileWriter output_file(output_path);
+
+        std::vector<unsigned int> neuron_counts;
+        while (peek_text_topology(input_file, neuron_counts)) {
+            NeuralNet network(unsigned(neuron_counts.size()), neuron_counts);
+            network.import_weights_stream(input_file);
+            network.export_weights_binary(output_file);
+            network_count++;
+        }
+        output_file.close();
+        std::cout << "Converted " << network_count << " networks from text to binary.\n";
+    }
+}
@@ -0,0 +1,105 @@
+// Copyright [2016] <duncan@wduncanfraser.com>
+// Implementation of GoBitBoard and bitset helpers
+
+#include <array>
+#include <vector>
+#include <cstdint>
+
+#include "gogame.h"
+#include "gobitboard.h"
+#include "gogamet.h"
+
+const GoZobristTable zobrist_table = make_zobrist_table();
+
+const GoBoardMasks &get_board_masks(const uint8_t board_size) {
+    // Masks for all sizes, generated once. Index is board size.
+    static const std::array<GoBoardMasks, GOBOARD_MAX_SIZE + 1> all_masks = [] {
+        std::array<GoBoardMasks, GOBOARD_MAX_SIZE + 1> result;
+        for (uint8_t size = 3; size <= GOBOARD_MAX_SIZE; size++) {
+            for (uint8_t y = 0; y < size; y++) {
+                for (uint8_t x = 0; x < size; x++) {
+                    uint16_t index = uint16_t(y * size + x);
+                    result[size].board.set(index);
+                    if (x > 0) {
+                        result[size].has_left.set(index);
+                    }
+                    if (x < size - 1) {
+                        result[size].has_right.set(index);
+                    }
+                }
+            }
+        }
+        return result;
+    }();
+
+    return all_masks[board_size];
+}
+
+GoBitSet get_adjacent_set(const GoBitSet &i_bitset, const uint8_t board_size) {
+    return get_go_kernels(board_size).adjacent_set(i_bitset);
+}
+
+GoBitSet flood_fill(GoBitSet seed, const GoBitSet &region, const uint8_t board_size) {
+    return get_go_kernels(board_size).flood_fill(seed, region);
+}
+
+GoBitBoard::GoBitBoard(const uint8_t i_board_size) : board_size(i_board_size), hash(0) {
+    // Check that board dimensions are between 3 and 19, otherwise throw
+    if ((board_size < 3) || (board_size > GOBOARD_MAX_SIZE)) {
+        throw GoBoardInitError();
+    }
+}
+
+GoBitBoard &GoBitBoard::operator=(const std::vector<std::vector<uint8_t>> &i_board) {
+    // Check that dimensions match the board size
+    if (i_board.size() != board_size) {
+        throw GoBoardInitError();
+    }
+
+    for (uint8_t y = 0; y < board_size; y++) {
+        (*this)[y] = i_board[y];
+    }
+    return *this;
+}
+
+GoBitBoard::operator std::vector<std::vector<uint8_t>>() const {
+    std::vector<std::vector<uint8_t>> result(board_size, std::vector<uint8_t>(board_size, 0));
+
+    for (uint8_t y = 0; y < board_size; y++) {
+        for (uint8_t x = 0; x < board_size; x++) {
+            result[y][x] = get(x, y);
+        }
+    }
+    return result;
+}
+
+void GoBitBoard::set_point(const uint16_t index, const uint8_t mask) {
+    if ((mask != 0) && (mask != BLACK_MASK) && (mask != WHITE_MASK)) {
+        throw GoBoardBadMask();
+    }
+
+    // Clear any existing stone, removing its key from the hash
+    for (uint8_t color = 0; color < 2; color++) {
+        if (stones[color].test(index)) {
+            stones[color].reset(index);
+            hash ^= get_zobrist_key(index, color);
+        }
+    }
+
+    // Place the new stone, if any
+    if (mask != 0) {
+        place_stone(index, get_piece_bool(mask));
+    }
+}
+
+GoBitBoard::Row &GoBitBoard::Row::operator=(const std::vector<uint8_t> &i_row) {
+    // Check that row size matches the board size
+    if (i_row.size() != parent.size()) {
+        throw GoBoardInitError();
+    }
+
+    for (uint8_t x = 0; x < parent.size(); x++) {
+        parent.set(x, y, i_row[x]);
+    }
+    return *this;
+}
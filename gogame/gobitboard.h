@@ -0,0 +1,395 @@
+// Copyright [2016] <duncan@wduncanfraser.com>
+// Fixed size bitset board backend used by GoBoard
+
+#ifndef GOGAME_GOBITBOARD_H_
+#define GOGAME_GOBITBOARD_H_
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <initializer_list>
+
+// Largest supported board is 19x19 = 361 points, which fits in 6 64 bit words.
+#define GOBOARD_MAX_SIZE 19
+#define GOBOARD_MAX_POINTS 361
+#define GOBITSET_WORDS 6
+
+// Class for holding one bit per board point. Points are indexed in row major order, (y * board_size) + x.
+// Bits past the last point of the board are always kept clear.
+class GoBitSet {
+ public:
+    std::array<uint64_t, GOBITSET_WORDS> words;
+
+    // Default Constructor. Initializes all bits to 0
+    GoBitSet() : words() { }
+
+    // Comparison Operators
+    inline bool operator==(const GoBitSet &i_bitset) const {
+        return words == i_bitset.words;
+    }
+
+    inline bool operator!=(const GoBitSet &i_bitset) const {
+        return words != i_bitset.words;
+    }
+
+    // Bitwise operators
+    inline GoBitSet& operator|=(const GoBitSet &i_bitset) {
+        for (unsigned int i = 0; i < GOBITSET_WORDS; i++) {
+            words[i] |= i_bitset.words[i];
+        }
+        return *this;
+    }
+
+    inline GoBitSet& operator&=(const GoBitSet &i_bitset) {
+        for (unsigned int i = 0; i < GOBITSET_WORDS; i++) {
+            words[i] &= i_bitset.words[i];
+        }
+        return *this;
+    }
+
+    inline GoBitSet& operator^=(const GoBitSet &i_bitset) {
+        for (unsigned int i = 0; i < GOBITSET_WORDS; i++) {
+            words[i] ^= i_bitset.words[i];
+        }
+        return *this;
+    }
+
+    inline GoBitSet operator|(const GoBitSet &i_bitset) const {
+        GoBitSet result(*this);
+        return result |= i_bitset;
+    }
+
+    inline GoBitSet operator&(const GoBitSet &i_bitset) const {
+        GoBitSet result(*this);
+        return result &= i_bitset;
+    }
+
+    inline GoBitSet operator^(const GoBitSet &i_bitset) const {
+        GoBitSet result(*this);
+        return result ^= i_bitset;
+    }
+
+    // Returns the bits set in this set and not in i_bitset
+    inline GoBitSet and_not(const GoBitSet &i_bitset) const {
+        GoBitSet result;
+        for (unsigned int i = 0; i < GOBITSET_WORDS; i++) {
+            result.words[i] = words[i] & ~i_bitset.words[i];
+        }
+        return result;
+    }
+
+    // Single bit access
+    inline bool test(const uint16_t index) const {
+        return (words[index >> 6] >> (index & 63)) & 1;
+    }
+
+    inline void set(const uint16_t index) {
+        words[index >> 6] |= uint64_t(1) << (index & 63);
+    }
+
+    inline void reset(const uint16_t index) {
+        words[index >> 6] &= ~(uint64_t(1) << (index & 63));
+    }
+
+    // Clears all bits
+    inline void clear() {
+        words.fill(0);
+    }
+
+    // Returns true if any bit is set
+    inline bool any() const {
+        uint64_t result = 0;
+        for (unsigned int i = 0; i < GOBITSET_WORDS; i++) {
+            result |= words[i];
+        }
+        return result != 0;
+    }
+
+    // Returns the number of set bits
+    inline uint16_t count() const {
+        uint16_t result = 0;
+        for (unsigned int i = 0; i < GOBITSET_WORDS; i++) {
+            result += uint16_t(__builtin_popcountll(words[i]));
+        }
+        return result;
+    }
+
+    // Returns the index of the lowest set bit. Set must not be empty.
+    inline uint16_t first() const {
+        unsigned int i = 0;
+        while (words[i] == 0) {
+            i++;
+        }
+        return uint16_t((i << 6) + __builtin_ctzll(words[i]));
+    }
+
+    // Removes and returns the index of the lowest set bit. Set must not be empty.
+    inline uint16_t pop_first() {
+        uint16_t index = first();
+        words[index >> 6] &= words[index >> 6] - 1;
+        return index;
+    }
+
+    // Calls function with the index of each set bit, in increasing order
+    template <typename Function>
+    inline void for_each(Function function) const {
+        for (unsigned int i = 0; i < GOBITSET_WORDS; i++) {
+            uint64_t word = words[i];
+            while (word) {
+                function(uint16_t((i << 6) + __builtin_ctzll(word)));
+                word &= word - 1;
+            }
+        }
+    }
+
+    // Shift all bits towards higher indices. 0 < shift < 64
+    inline GoBitSet shift_up(const unsigned int shift) const {
+        GoBitSet result;
+        result.words[0] = words[0] << shift;
+        for (unsigned int i = 1; i < GOBITSET_WORDS; i++) {
+            result.words[i] = (words[i] << shift) | (words[i - 1] >> (64 - shift));
+        }
+        return result;
+    }
+
+    // Shift all bits towards lower indices. 0 < shift < 64
+    inline GoBitSet shift_down(const unsigned int shift) const {
+        GoBitSet result;
+        for (unsigned int i = 0; i < GOBITSET_WORDS - 1; i++) {
+            result.words[i] = (words[i] >> shift) | (words[i + 1] << (64 - shift));
+        }
+        result.words[GOBITSET_WORDS - 1] = words[GOBITSET_WORDS - 1] >> shift;
+        return result;
+    }
+};
+
+// Table of Zobrist keys, one per point per color. keys[0] = black, keys[1] = white
+struct GoZobristTable {
+    uint64_t keys[2][GOBOARD_MAX_POINTS];
+};
+
+// Function to generate the Zobrist table at compile time using splitmix64, so keys are identical between runs.
+constexpr GoZobristTable make_zobrist_table() {
+    GoZobristTable result {};
+    uint64_t state = 0x5ca1ab1e60ba11ULL;
+    for (unsigned int color = 0; color < 2; color++) {
+        for (unsigned int i = 0; i < GOBOARD_MAX_POINTS; i++) {
+            state += 0x9e3779b97f4a7c15ULL;
+            uint64_t z = state;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            result.keys[color][i] = z ^ (z >> 31);
+        }
+    }
+    return result;
+}
+
+extern const GoZobristTable zobrist_table;
+
+// Function to get the Zobrist key for a stone of color on point index. black = 0, white = 1
+inline uint64_t get_zobrist_key(const uint16_t index, const bool color) {
+    return zobrist_table.keys[color][index];
+}
+
+// Precomputed masks for a given board size
+struct GoBoardMasks {
+    // All points on the board
+    GoBitSet board;
+    // Points that have a neighbour to the left (x > 0)
+    GoBitSet has_left;
+    // Points that have a neighbour to the right (x < size - 1)
+    GoBitSet has_right;
+};
+
+// Function to get the precomputed masks for a board size. Size must be between 3 and 19.
+const GoBoardMasks &get_board_masks(const uint8_t board_size);
+
+// Function to get all points orthogonally adjacent to the passed set, excluding points outside the board.
+// The result may include points from the passed set. Dispatches to the GoGameT kernel for the board size.
+GoBitSet get_adjacent_set(const GoBitSet &i_bitset, const uint8_t board_size);
+
+// Function to expand seed to all connected points in region. Seed should be a subset of region.
+// Dispatches to the GoGameT kernel for the board size.
+GoBitSet flood_fill(GoBitSet seed, const GoBitSet &region, const uint8_t board_size);
+
+// Class holding black and white stones as bitsets.
+// Provides board[y][x] style access through proxies for compatibility with the nested vector representation.
+class GoBitBoard {
+ private:
+    // Board size
+    uint8_t board_size;
+
+    // Stones of each color. stones[0] = black, stones[1] = white
+    std::array<GoBitSet, 2> stones;
+
+    // Zobrist hash of the current stones. Updated incrementally on every change. An empty board hashes to 0.
+    uint64_t hash;
+
+ public:
+    // Proxy for a single board point
+    class Cell {
+     private:
+        GoBitBoard &parent;
+        uint16_t index;
+
+     public:
+        Cell(GoBitBoard &i_parent, const uint16_t i_index) : parent(i_parent), index(i_index) { }
+
+        // Read point mask
+        inline operator uint8_t() const {
+            return parent.get_point(index);
+        }
+
+        // Assign point mask
+        inline Cell &operator=(const uint8_t mask) {
+            parent.set_point(index, mask);
+            return *this;
+        }
+
+        inline Cell &operator=(const Cell &i_cell) {
+            parent.set_point(index, uint8_t(i_cell));
+            return *this;
+        }
+    };
+
+    // Proxy for a single board row
+    class Row {
+     private:
+        GoBitBoard &parent;
+        uint8_t y;
+
+     public:
+        Row(GoBitBoard &i_parent, const uint8_t i_y) : parent(i_parent), y(i_y) { }
+
+        inline Cell operator[](const uint8_t x) {
+            return Cell(parent, parent.get_index(x, y));
+        }
+
+        inline uint8_t operator[](const uint8_t x) const {
+            return parent.get(x, y);
+        }
+
+        // Assign a complete row. Throws GoBoardInitError if row size does not match board size.
+        Row &operator=(const std::vector<uint8_t> &i_row);
+
+        Row &operator=(std::initializer_list<uint8_t> i_row) {
+            return *this = std::vector<uint8_t>(i_row);
+        }
+    };
+
+    // Proxy for a single read only board row
+    class ConstRow {
+     private:
+        const GoBitBoard &parent;
+        uint8_t y;
+
+     public:
+        ConstRow(const GoBitBoard &i_parent, const uint8_t i_y) : parent(i_parent), y(i_y) { }
+
+        inline uint8_t operator[](const uint8_t x) const {
+            return parent.get(x, y);
+        }
+    };
+
+    // Constructor with size specification. Board is initialized empty.
+    explicit GoBitBoard(const uint8_t i_board_size);
+
+    // Comparison Operators
+    inline bool operator==(const GoBitBoard &i_bitboard) const {
+        return (board_size == i_bitboard.board_size) && (stones == i_bitboard.stones);
+    }
+
+    inline bool operator!=(const GoBitBoard &i_bitboard) const {
+        return !(*this == i_bitboard);
+    }
+
+    // Assign from nested vector representation. Throws GoBoardInitError if dimensions do not match board size.
+    GoBitBoard &operator=(const std::vector<std::vector<uint8_t>> &i_board);
+
+    // Convert to nested vector representation
+    operator std::vector<std::vector<uint8_t>>() const;
+
+    // Row access
+    inline Row operator[](const uint8_t y) {
+        return Row(*this, y);
+    }
+
+    inline ConstRow operator[](const uint8_t y) const {
+        return ConstRow(*this, y);
+    }
+
+    // Function to get the board size
+    inline uint8_t size() const {
+        return board_size;
+    }
+
+    // Function to get the point index for coordinates
+    inline uint16_t get_index(const uint8_t x, const uint8_t y) const {
+        return uint16_t(y * board_size + x);
+    }
+
+    // Function to get the point mask at index. 0 = empty, BLACK_MASK = black, WHITE_MASK = white
+    inline uint8_t get_point(const uint16_t index) const {
+        // BLACK_MASK = 1, WHITE_MASK = 3
+        return uint8_t(stones[0].test(index) | (stones[1].test(index) * 3));
+    }
+
+    // Function to get the point mask at coordinates
+    inline uint8_t get(const uint8_t x, const uint8_t y) const {
+        return get_point(get_index(x, y));
+    }
+
+    // Function to set point mask at index. Throws GoBoardBadMask on an unknown mask.
+    void set_point(const uint16_t index, const uint8_t mask);
+
+    // Function to set point mask at coordinates
+    inline void set(const uint8_t x, const uint8_t y, const uint8_t mask) {
+        set_point(get_index(x, y), mask);
+    }
+
+    // Function to place a stone on an empty point. black = 0, white = 1
+    inline void place_stone(const uint16_t index, const bool color) {
+        stones[color].set(index);
+        hash ^= get_zobrist_key(index, color);
+    }
+
+    // Function to remove a single stone from the board. black = 0, white = 1
+    inline void remove_stone(const uint16_t index, const bool color) {
+        stones[color].reset(index);
+        hash ^= get_zobrist_key(index, color);
+    }
+
+    // Function to add a stone set of a color to the board. All members of i_stones must be empty points.
+    inline void add_stones(const GoBitSet &i_stones, const bool color) {
+        stones[color] |= i_stones;
+        i_stones.for_each([this, color](const uint16_t index) {
+            hash ^= get_zobrist_key(index, color);
+        });
+    }
+
+    // Function to remove a stone set of a color from the board. black = 0, white = 1
+    // All members of i_stones must be stones of the specified color.
+    inline void remove_stones(const GoBitSet &i_stones, const bool color) {
+        stones[color] ^= i_stones;
+        i_stones.for_each([this, color](const uint16_t index) {
+            hash ^= get_zobrist_key(index, color);
+        });
+    }
+
+    // Function to get the Zobrist hash of the board
+    inline uint64_t get_hash() const {
+        return hash;
+    }
+
+    // Function to get the stones of a color. black = 0, white = 1
+    inline const GoBitSet &get_stones(const bool color) const {
+        return stones[color];
+    }
+
+    // Function to get the empty points
+    inline GoBitSet get_empty() const {
+        return get_board_masks(board_size).board.and_not(stones[0] | stones[1]);
+    }
+};
+
+#endif  // GOGAME_GOBITBOARD_H_
@@ -2,6 +2,7 @@
 // Implementation of GoGame and related classes
 
 #include <algorithm>
+#include <memory>
 #include <vector>
 #include <cstdint>
 
@@ -24,22 +25,9 @@ XYCoordinate& XYCoordinate::operator=(const XYCoordinate &i_coordinate) {
     return *this;
 }
 
-GoBoard::GoBoard(const uint8_t board_size) {
-    // Check that board dimensions are between 3 and 19, otherwise throw
-    if ((board_size < 3) || (board_size > 19)) {
-        throw GoBoardInitError();
-    }
-
-    // Resize board vector to board dimensions. Initialize all cells to 0.
-    board.resize(board_size);
-
-    for (std::vector<uint8_t> &row : board) {
-        row.resize(board_size, 0);
-    }
-}
-
-GoBoard::GoBoard(const std::vector<std::vector<uint8_t>> &i_board) {
-    // Check that board dimensions are between 3 and 19, and square; otherwise throw.
+// Function to validate a nested vector board and get its size.
+// Board dimensions must be between 3 and 19, and square; otherwise throw.
+static uint8_t get_vector_board_size(const std::vector<std::vector<uint8_t>> &i_board) {
     uint64_t x_dim = i_board.size();
 
     // Checking X dimension
@@ -54,6 +42,12 @@ GoBoard::GoBoard(const std::vector<std::vector<uint8_t>> &i_board) {
         }
     }
 
+    return uint8_t(x_dim);
+}
+
+GoBoard::GoBoard(const uint8_t board_size) : board(board_size) { }
+
+GoBoard::GoBoard(const std::vector<std::vector<uint8_t>> &i_board) : board(get_vector_board_size(i_board)) {
     // Checks complete, assign board
     board = i_board;
 }
@@ -73,11 +67,8 @@ GoBoard& GoBoard::operator=(const GoBoard &i_goboard) {
 }
 
 const uint8_t GoBoard::get_size() const {
-    // Validate we don't have an out of bound size. If we do, throw an Unknown Error.
-    if ((board.size() < 3) || (board.size() > 19)) {
-        throw GoBoardUnknownError();
-    }
-    return (uint8_t) board.size();
+    // Size is validated when the board is constructed, so this does not need to be checked again.
+    return board.size();
 }
 
 const inline bool GoBoard::within_bounds(const XYCoordinate &i_piece) const {
@@ -86,8 +77,8 @@ const inline bool GoBoard::within_bounds(const XYCoordinate &i_piece) const {
 }
 
 GoString::GoString(uint8_t i_board_size) {
-    // Validate max is less than maximum board size, or throw
-    if (i_board_size > 19) {
+    // Validate board size is between 3 and 19, or throw
+    if ((i_board_size < 3) || (i_board_size > 19)) {
         throw GoBoardInitError();
     }
     board_size = i_board_size;
@@ -132,15 +123,11 @@ bool GoString::append_member(const XYCoordinate &coordinate) {
         // Check if the coordinate is adjacent to existing members
         // Rather than checking every element in the string for adjacency, get the adjacent pieces around coordinate
         // and do a std::find against members
-        std::vector<XYCoordinate> adjacent_coordinates = get_adjacent(coordinate, board_size);
-
-        for (const XYCoordinate &element : adjacent_coordinates) {
-            if (std::find(members.begin(), members.end(), element) != members.end()) {
-                // If found, set adjacent to true and break
+        for_each_adjacent(coordinate, board_size, [this, &adjacent](const XYCoordinate &element) {
+            if (!adjacent && (std::find(members.begin(), members.end(), element) != members.end())) {
                 adjacent = true;
-                break;
             }
-        }
+        });
     } else {
         // override adjacent to true for the first member
         adjacent = true;
@@ -174,15 +161,11 @@ bool GoString::append_liberty(const XYCoordinate &coordinate) {
     // Check if the coordinate is adjacent to existing members
     // Rather than checking every element in the string for adjacency, get the adjacent pieces around coordinate
     // and do a std::find against members
-    std::vector<XYCoordinate> adjacent_coordinates = get_adjacent(coordinate, board_size);
-
-    for (const XYCoordinate &element : adjacent_coordinates) {
-        if (std::find(members.begin(), members.end(), element) != members.end()) {
-            // If found, set adjacent to true and break
+    for_each_adjacent(coordinate, board_size, [this, &adjacent](const XYCoordinate &element) {
+        if (!adjacent && (std::find(members.begin(), members.end(), element) != members.end())) {
             adjacent = true;
-            break;
         }
-    }
+    });
 
     // If we got this far, and piece is adjacent, append
     if (adjacent) {
@@ -223,156 +206,182 @@ const uint8_t GoString::get_border() const {
     return territory_border;
 }
 
-GoMove::GoMove(const GoBoard &i_goboard) : goboard(i_goboard), piece(XYCoordinate(0, 0)),
-                                           prisoners_captured(0), pass(true) { }
+GoMove::GoMove(const GoBoard &i_goboard) : goboard(std::make_shared<const GoBoard>(i_goboard)),
+                                           hash(i_goboard.board.get_hash()), piece(XYCoordinate(0, 0)),
+                                           prisoners_captured(0), pass(true), deferred(false), color(0) { }
 
-GoMove::GoMove(const GoBoard &i_goboard, const XYCoordinate &i_piece) : goboard(i_goboard), piece(i_piece),
-                                                                        prisoners_captured(0), pass(false) {
+GoMove::GoMove(const GoBoard &i_goboard, const XYCoordinate &i_piece) :
+        goboard(std::make_shared<const GoBoard>(i_goboard)), hash(i_goboard.board.get_hash()), piece(i_piece),
+        prisoners_captured(0), pass(false), deferred(false), color(0) {
     // Check that move is within bounds
-    if (!goboard.within_bounds(i_piece)) {
+    if (!goboard->within_bounds(i_piece)) {
         throw GoBoardInitError();
     }
 }
 
+GoMove::GoMove(const std::shared_ptr<const GoBoard> &i_goboard) :
+        goboard(i_goboard), hash(i_goboard->board.get_hash()), piece(XYCoordinate(0, 0)), prisoners_captured(0),
+        pass(true), deferred(false), color(0) { }
+
+GoMove::GoMove(const std::shared_ptr<const GoBoard> &i_goboard, const XYCoordinate &i_piece, const bool i_color,
+               const uint8_t i_prisoners_captured, const uint64_t i_hash) :
+        goboard(i_goboard), hash(i_hash), piece(i_piece), prisoners_captured(i_prisoners_captured), pass(false),
+        deferred(true), color(i_color) { }
+
 bool GoMove::operator==(const GoMove &i_move) const {
-    return (goboard == i_move.goboard) && (piece == i_move.piece) &&
-            (prisoners_captured == i_move.prisoners_captured) && (pass == i_move.pass);
+    // Compare the compact fields first. Only materialize boards if everything else matches.
+    if ((hash != i_move.hash) || !(piece == i_move.piece) || (prisoners_captured != i_move.prisoners_captured) ||
+            (pass != i_move.pass)) {
+        return false;
+    }
+    if ((goboard == i_move.goboard) && (deferred == i_move.deferred) && (color == i_move.color)) {
+        return true;
+    }
+    return this->get_board() == i_move.get_board();
 }
 
 GoMove& GoMove::operator=(const GoMove &i_move) {
     if (this != &i_move) {
         // Copy variables
         goboard = i_move.goboard;
+        hash = i_move.hash;
         piece = i_move.piece;
         prisoners_captured = i_move.prisoners_captured;
         pass = i_move.pass;
+        deferred = i_move.deferred;
+        color = i_move.color;
     }
     return *this;
 }
 
 const GoString GoMove::construct_string(GoString i_string, const bool color) const {
     // take the passed string, and determine all the elements and liberty
+    // Get the resultant board to construct the string on
+    GoBoard string_board = this->get_board();
     // Setup list of coordinates to check, starting with passed members
     std::vector<XYCoordinate> coordinates_check = i_string.get_members();
 
-    while (coordinates_check.size() != 0) {
-        // TODO(wdfraser): Make this faster
-        // Check adjacency for the first element
-        std::vector<XYCoordinate> adjacent_coordinates =
-                get_adjacent(coordinates_check.front(), uint8_t(goboard.get_size()));
-        for (XYCoordinate &element : adjacent_coordinates) {
-            if (goboard.board[element.y][element.x] == 0) {
+    // Coordinates are checked in order, with newly found members appended to the end
+    for (size_t i = 0; i < coordinates_check.size(); i++) {
+        for_each_adjacent(coordinates_check[i], string_board.get_size(), [&](const XYCoordinate &element) {
+            uint8_t element_mask = string_board.board.get(element.x, element.y);
+            if (element_mask == 0) {
                 // If blank, attempt to append to liberty. Fail silently if already part of liberty.
                 i_string.append_liberty(element);
-            } else if (goboard.board[element.y][element.x] == get_mask(color)) {
+            } else if (element_mask == get_mask(color)) {
                 // If part of string, attempt to append to members.
                 // If successful appending to members, add to check list
                 if (i_string.append_member(element)) {
                     coordinates_check.push_back(element);
                 }
             }
-        }
-
-        // Done checking, remove first element from check list
-        coordinates_check.erase(coordinates_check.begin());
+        });
     }
 
     return i_string;
 }
 
 bool GoMove::remove_string(const GoString &i_string, const bool color) {
-    // Setup temporary board to test string against
-    GoBoard temp_board(goboard);
-    // Loop through each element, removing elements
+    // Setup temporary board to remove the string from
+    GoBoard temp_board = this->get_board();
+
+    // Collect the string members, checking each is a stone of the specified color
+    GoBitSet string_stones;
     for (const XYCoordinate &element : i_string.get_members()) {
-        if (temp_board.board[element.y][element.x] == get_mask(color)) {
-            temp_board.board[element.y][element.x] = 0;
+        if (temp_board.board.get(element.x, element.y) == get_mask(color)) {
+            string_stones.set(temp_board.board.get_index(element.x, element.y));
         } else {
             return false;
         }
     }
 
-    // If we made it here, all elements were removed from temp_board correctly. set goboard to temp_board
-    // and return true
-    goboard = temp_board;
+    // If we made it here, all elements are valid. Remove them from the board, store it and return true
+    temp_board.board.remove_stones(string_stones, color);
+    goboard = std::make_shared<const GoBoard>(temp_board);
+    hash = temp_board.board.get_hash();
+    deferred = false;
     return true;
 }
 
-int GoMove::check_move(const bool color) {
-    // Check if this is a pass move. If it is, return 0.
-    if (pass) {
-        return 0;
-    }
-    // Check if the calculation has already been made (piece placed), as that is the most basic end case
-    if (goboard.board[piece.y][piece.x] != 0) {
+int GoMove::place_piece(GoBoard &i_goboard, const bool i_color) {
+    uint8_t board_size = i_goboard.board.size();
+    uint16_t index = i_goboard.board.get_index(piece.x, piece.y);
+
+    // Check if the piece has already been placed, as that is the most basic end case
+    if (i_goboard.board.get_point(index) != 0) {
         return -1;
     }
     // Place the piece on the board
-    goboard.board[piece.y][piece.x] = get_mask(color);
-
-    // Calculate the effects on the board
-    // Check adjacent pieces to see if they are part of the same string, blank, or the enemy
-    GoString move_string(uint8_t(goboard.get_size()));
-    // Append the placed piece to the String
-    move_string.append_member(XYCoordinate(piece.x, piece.y));
-
-    // Setup vector to hold enemy pieces
-    std::vector<XYCoordinate> enemy_pieces;
-
-    // Get the adjacent pieces and check their classification
-    std::vector<XYCoordinate> adjacent_pieces =
-            get_adjacent(XYCoordinate(piece.x, piece.y), uint8_t(goboard.get_size()));
-
-    for (const XYCoordinate &element : adjacent_pieces) {
-        if (goboard.board[element.y][element.x] == 0) {
-            move_string.append_liberty(element);
-        } else if (goboard.board[element.y][element.x] == get_mask(color)) {
-            move_string.append_member(element);
-        } else {
-            enemy_pieces.push_back(element);
-        }
-    }
+    i_goboard.board.place_stone(index, i_color);
 
-    // Check impact on enemy pieces
-    for (const XYCoordinate &element : enemy_pieces) {
-        // Double check that the piece still exists (wasn't remove as part of a prior string)
-        // If empty, skip
-        if (goboard.board[element.y][element.x] == 0) {
-            continue;
-        }
-        GoString temp_string(uint8_t(goboard.get_size()));
-        temp_string.append_member(element);
-        temp_string = this->construct_string(temp_string, !color);
-
-        // If the enemy string has no liberty, remove from the board
-        if (temp_string.get_liberty_count() == 0) {
-            if (!this->remove_string(temp_string, !color)) {
-                // If we failed to remove the string we just built... something is very very wrong
-                throw GoBoardUnknownError();
-            } else {
-                // If remove was succesful, append size of removed string to captured prisoners
-                prisoners_captured += temp_string.get_member_count();
-            }
+    GoBitSet placed;
+    placed.set(index);
+
+    // Check impact on adjacent enemy strings. Each string is flood filled once.
+    GoBitSet enemy_pieces = get_adjacent_set(placed, board_size) & i_goboard.board.get_stones(!i_color);
+    GoBitSet empty = i_goboard.board.get_empty();
+
+    while (enemy_pieces.any()) {
+        GoBitSet enemy_seed;
+        enemy_seed.set(enemy_pieces.first());
+        GoBitSet enemy_string = flood_fill(enemy_seed, i_goboard.board.get_stones(!i_color), board_size);
+        enemy_pieces = enemy_pieces.and_not(enemy_string);
+
+        // If the enemy string has no liberty, remove from the board and append to captured prisoners
+        if (!(get_adjacent_set(enemy_string, board_size) & empty).any()) {
+            i_goboard.board.remove_stones(enemy_string, !i_color);
+            prisoners_captured += uint8_t(enemy_string.count());
         }
     }
 
     // Construct the string to determine string liberty
-    // On single pieces, This will account for new liberty due to removed pieces
-    move_string = this->construct_string(move_string, color);
+    // This will account for new liberty due to removed pieces
+    GoBitSet move_string = flood_fill(placed, i_goboard.board.get_stones(i_color), board_size);
+    GoBitSet move_liberty = get_adjacent_set(move_string, board_size) & i_goboard.board.get_empty();
 
     // If the move_string has 0 liberty, remove it from the board
-    if (move_string.get_liberty_count() == 0) {
-        if (!this->remove_string(move_string, color)) {
-            // If we failed to remove the string we just built... something is very very wrong
-            throw GoBoardUnknownError();
-        }
+    if (!move_liberty.any()) {
+        i_goboard.board.remove_stones(move_string, i_color);
+    }
+
+    return static_cast<int>(move_liberty.count());
+}
+
+int GoMove::check_move(const bool color) {
+    // Check if this is a pass move. If it is, return 0.
+    if (pass) {
+        return 0;
+    }
+    // Deferred moves already have the piece placed
+    if (deferred) {
+        return -1;
     }
 
-    return static_cast<int>(move_string.get_liberty_count());
+    // Determine the impact on a copy of the board, and store the copy if the piece was placed
+    GoBoard result_board(*goboard);
+    int liberty = this->place_piece(result_board, color);
+    if (liberty != -1) {
+        goboard = std::make_shared<const GoBoard>(result_board);
+        hash = result_board.board.get_hash();
+        this->color = color;
+    }
+    return liberty;
 }
 
 const GoBoard GoMove::get_board() const {
-    return goboard;
+    if (!deferred) {
+        return *goboard;
+    }
+
+    // Materialize the resultant board by placing the piece on a copy of the original board.
+    GoBoard result_board(*goboard);
+    GoMove temp_move(*this);
+    temp_move.place_piece(result_board, color);
+    return result_board;
+}
+
+const uint64_t GoMove::get_hash() const {
+    return hash;
 }
 
 const XYCoordinate GoMove::get_piece() const {
@@ -387,22 +396,31 @@ const bool GoMove::check_pass() const {
     return pass;
 }
 
-GoGame::GoGame(const uint8_t board_size) : goboard(board_size) {
+GoGame::GoGame(const uint8_t board_size, const GoRules &i_rules) : goboard(board_size), rules(i_rules),
+                                                                   strings(goboard.board) {
     // Set flags
     move_list_dirty = true;
+    history_verification = false;
     prisoner_count.fill(0);
     pieces_placed.fill(0);
 }
 
-GoGame::GoGame(const GoBoard &i_goboard) : goboard(i_goboard) {
+GoGame::GoGame(const GoBoard &i_goboard, const GoRules &i_rules) : goboard(i_goboard), rules(i_rules),
+                                                                   strings(goboard.board) {
     // Set flags
     move_list_dirty = true;
+    history_verification = false;
     prisoner_count.fill(0);
     pieces_placed.fill(0);
 }
 
-GoGame::GoGame(const GoGame &i_gogame) : goboard(i_gogame.goboard), move_list(i_gogame.move_list),
+GoGame::GoGame(const GoGame &i_gogame) : goboard(i_gogame.goboard), rules(i_gogame.rules),
+                                             strings(i_gogame.strings),
+                                             move_list(i_gogame.move_list),
                                              move_history(i_gogame.move_history),
+                                             history_hashes(i_gogame.history_hashes),
+                                             history_verification(i_gogame.history_verification),
+                                             undo_stack(i_gogame.undo_stack),
                                              move_list_dirty(i_gogame.move_list_dirty),
                                              move_list_color(i_gogame.move_list_color),
                                              prisoner_count(i_gogame.prisoner_count),
@@ -417,7 +435,7 @@ const uint8_t GoGame::get_size() const {
     return goboard.get_size();
 }
 
-const GoBoard GoGame::get_board() const {
+const GoBoard &GoGame::get_board() const {
     return goboard;
 }
 
@@ -428,6 +446,9 @@ void GoGame::set_board(const GoBoard &i_goboard) {
     }
 
     goboard = i_goboard;
+    strings.rebuild(goboard.board);
+    undo_stack.clear();
+    move_list_dirty = true;
 }
 
 const std::vector<GoMove> GoGame::get_move_list() const {
@@ -438,6 +459,18 @@ const std::vector<GoMove> GoGame::get_move_history() const {
     return move_history;
 }
 
+const uint64_t GoGame::get_hash() const {
+    return goboard.board.get_hash();
+}
+
+const GoRules GoGame::get_rules() const {
+    return rules;
+}
+
+void GoGame::set_history_verification(const bool verify) {
+    history_verification = verify;
+}
+
 const std::array<uint8_t, 2> GoGame::get_prisoner_count() const {
     return prisoner_count;
 }
@@ -447,14 +480,95 @@ const std::array<uint8_t, 2> GoGame::get_pieces_placed() const {
 }
 
 const bool GoGame::check_move_history(const GoMove &i_move) const {
+    // Check the hash set first. If the hash has not been seen, the board state is new.
+    uint64_t key = this->get_history_key(i_move.hash, i_move.color);
+    if (history_hashes.find(key) == history_hashes.end()) {
+        return false;
+    }
+
+    if (!history_verification) {
+        return true;
+    }
+
+    // Confirm the hash match against the full board, in case of a collision
+    const GoBoard move_board = i_move.get_board();
     for (const GoMove &row : move_history) {
-        if (row.goboard == i_move.goboard) {
+        if ((this->get_history_key(row.hash, row.color) == key) && (row.get_board() == move_board)) {
             return true;
         }
     }
     return false;
 }
 
+// Function to get the hash of the board after color plays at index, from the hash before and the effect of the move
+static inline uint64_t get_result_hash(const uint64_t base_hash, const GoMoveEffect &effect, const uint16_t index,
+                                       const bool color) {
+    uint64_t result = base_hash ^ get_zobrist_key(index, color);
+    effect.captured.for_each([&result, color](const uint16_t captured) {
+        result ^= get_zobrist_key(captured, !color);
+    });
+    // Suicided stones include the placed stone, so its key is removed again
+    effect.suicided.for_each([&result, color](const uint16_t suicided) {
+        result ^= get_zobrist_key(suicided, color);
+    });
+    return result;
+}
+
+const GoBitSet GoGame::generate_legal_points(const bool color) const {
+    uint8_t board_size = this->get_size();
+    const GoBitSet empty = goboard.board.get_empty();
+    uint64_t base_hash = goboard.board.get_hash();
+
+    // Find the liberty of every enemy string in atari, as playing there captures
+    GoBitSet capturing;
+    GoBitSet enemy = goboard.board.get_stones(!color);
+    while (enemy.any()) {
+        uint16_t root = strings.find(enemy.first());
+        if (strings.get_liberty(root).count() == 1) {
+            capturing |= strings.get_liberty(root);
+        }
+        enemy = enemy.and_not(strings.get_members(root));
+    }
+
+    // A point with an empty neighbour is never suicide. Without a capture, only the placed stone changes the hash.
+    GoBitSet simple = (empty & get_adjacent_set(empty, board_size)).and_not(capturing);
+    GoBitSet legal;
+
+    simple.for_each([&](const uint16_t index) {
+        if (!this->check_hash_history(base_hash ^ get_zobrist_key(index, color), index, color)) {
+            legal.set(index);
+        }
+    });
+
+    // Remaining points are surrounded or capture, so determine their effect from the string table
+    empty.and_not(simple).for_each([&](const uint16_t index) {
+        GoMoveEffect effect = strings.check_move(goboard.board, index, color);
+        // Suicide of a single stone leaves the board unchanged, so it is never allowed
+        if (effect.suicide && (!rules.suicide_allowed || (effect.suicided.count() == 1))) {
+            return;
+        }
+        if (!this->check_hash_history(get_result_hash(base_hash, effect, index, color), index, color)) {
+            legal.set(index);
+        }
+    });
+
+    return legal;
+}
+
+const bool GoGame::check_hash_history(const uint64_t i_hash, const uint16_t index, const bool color) const {
+    if (history_hashes.find(this->get_history_key(i_hash, color)) == history_hashes.end()) {
+        return false;
+    }
+    if (!history_verification) {
+        return true;
+    }
+
+    // Possible repeat. Simulate the move to confirm against the full board.
+    GoMove p_move(goboard, XYCoordinate(uint8_t(index % this->get_size()), uint8_t(index / this->get_size())));
+    p_move.check_move(color);
+    return this->check_move_history(p_move);
+}
+
 bool GoGame::generate_moves(const bool color) {
     // Check if move list is dirty, so we don't generate the same list
     if ((move_list_dirty) || (move_list_color != color)) {
@@ -464,35 +578,24 @@ bool GoGame::generate_moves(const bool color) {
         // Get the board size
         uint8_t board_size = this->get_size();
 
-        // Go through board element by element, checking for valid moves
-        for (uint8_t y = 0; y < board_size; y++) {
-            for (uint8_t x = 0; x < board_size; x++) {
-                // Check if there is a piece first, as that is the most basic end case
-                if (goboard.board[y][x] != 0) {
-                    continue;
-                }
-                // p short for potential. Create a move with the piece to be assigned
-                GoMove p_board(goboard, XYCoordinate(x, y));
-
-                // Based on the placed piece, determine the effect on the board
-                // Check if the move is a suicide (has no liberty), as suicides are not allowed
-                if (p_board.check_move(color) == 0) {
-                    continue;
-                }
+        // All generated moves share a single copy of the current board
+        std::shared_ptr<const GoBoard> base_board = std::make_shared<const GoBoard>(goboard);
+        uint64_t base_hash = goboard.board.get_hash();
 
-                // Check if the outcome is a preexisting board state
-                if (this->check_move_history(p_board)) {
-                    continue;
-                }
+        // Create a move for every legal point, in board order
+        this->generate_legal_points(color).for_each([&](const uint16_t index) {
+            // Based on the string table, determine the captured stones and resultant hash
+            GoMoveEffect effect = strings.check_move(goboard.board, index, color);
+            uint64_t p_hash = get_result_hash(base_hash, effect, index, color);
 
-                // All checks have passed, append to the move_list
-                move_list.push_back(p_board);
-            }
-        }
+            // p short for potential. Create a deferred move, the board is only built if requested
+            move_list.push_back(GoMove(base_board, XYCoordinate(uint8_t(index % board_size),
+                                                                uint8_t(index / board_size)),
+                                       color, uint8_t(effect.captured.count()), p_hash));
+        });
 
         // Append a pass as a valid move
-        GoMove pass_move(goboard);
-        move_list.push_back(pass_move);
+        move_list.push_back(GoMove(base_board));
 
         // Set move_list flags
         move_list_dirty = false;
@@ -507,13 +610,7 @@ void GoGame::make_move(const GoMove &i_move, const bool color) {
     // Not validating size as that is handled implicitly by comparing against the move list
     // Check if move is a pass. If it is, handle and exit.
     if (i_move.check_pass()) {
-        move_history.push_back(i_move);
-        // No change in board. Add prisoner to other team. And append pieces_places
-        prisoner_count[!color] += 1;
-        pieces_placed[color] += 1;
-
-        // Set move_list to dirty
-        move_list_dirty = true;
+        this->play(i_move, color);
         return;
     }
 
@@ -523,23 +620,87 @@ void GoGame::make_move(const GoMove &i_move, const bool color) {
     // Check if move is in move list
     if (std::find(move_list.begin(), move_list.end(), i_move) != move_list.end()) {
         // GoMove is valid, update board
-        move_history.push_back(i_move);
-        goboard = i_move.goboard;
-
-        // Add prisoners from move
-        prisoner_count[color] += i_move.get_prisoners_captured();
-
-        // Add count to pieces placed;
-        pieces_placed[color] += 1;
-
-        // Set move_list to dirty
-        move_list_dirty = true;
+        this->play(i_move, color);
     } else {
         // Not a valid move, throw
         throw GoBoardBadMove();
     }
 }
 
+void GoGame::play(const GoMove &i_move, const bool color) {
+    // Setup undo record with the current counts
+    GoUndoRecord record;
+    record.prisoner_count = prisoner_count;
+    record.pieces_placed = pieces_placed;
+    record.index = 0;
+    record.color = color;
+    record.pass = i_move.check_pass();
+
+    if (record.pass) {
+        // No change in board. Add prisoner to other team.
+        prisoner_count[!color] += 1;
+    } else {
+        // Place the piece, removing captured stones and updating strings
+        record.index = goboard.board.get_index(i_move.piece.x, i_move.piece.y);
+        GoMoveEffect effect = strings.play(goboard.board, record.index, color);
+        record.captured = effect.captured;
+        record.suicided = effect.suicided;
+
+        // Add prisoners from move. Suicided stones are prisoners for the other team.
+        prisoner_count[color] += uint8_t(record.captured.count());
+        prisoner_count[!color] += uint8_t(record.suicided.count());
+    }
+
+    // Add count to pieces placed
+    pieces_placed[color] += 1;
+
+    move_history.push_back(i_move);
+    move_history.back().color = color;
+    history_hashes.insert(this->get_history_key(i_move.hash, color));
+    undo_stack.push_back(record);
+
+    // Set move_list to dirty
+    move_list_dirty = true;
+}
+
+void GoGame::undo() {
+    if (undo_stack.empty()) {
+        throw GoBoardBadUndo();
+    }
+
+    const GoUndoRecord &record = undo_stack.back();
+
+    if (!record.pass) {
+        // Remove the placed piece and return captured stones. After a suicide, the placed piece is already gone and
+        // the rest of the suicided string is returned.
+        if (record.suicided.any()) {
+            GoBitSet returned = record.suicided;
+            returned.reset(record.index);
+            goboard.board.add_stones(returned, record.color);
+        } else {
+            goboard.board.remove_stone(record.index, record.color);
+        }
+        goboard.board.add_stones(record.captured, !record.color);
+
+        // Rebuild the strings touching the placed piece, captured and suicided stones
+        GoBitSet changed = record.captured | record.suicided;
+        changed.set(record.index);
+        strings.refresh(goboard.board, changed | get_adjacent_set(changed, goboard.board.size()));
+    }
+
+    // Restore counts
+    prisoner_count = record.prisoner_count;
+    pieces_placed = record.pieces_placed;
+
+    // Remove a single instance of the move from history
+    history_hashes.erase(history_hashes.find(this->get_history_key(move_history.back().hash, record.color)));
+    move_history.pop_back();
+    undo_stack.pop_back();
+
+    // Set move_list to dirty
+    move_list_dirty = true;
+}
+
 const GoString GoGame::construct_territory_string(GoString i_string) const {
     // take the passed string, and determine all the elements and liberty
     // Setup list of coordinates to check, starting with passed members
@@ -554,13 +715,11 @@ const GoString GoGame::construct_territory_string(GoString i_string) const {
     bool neutral_territory = false;
 
 
-    while (coordinates_check.size() != 0) {
-        // TODO(wdfraser): Make this faster
-        // Check adjacency for the first element
-        std::vector<XYCoordinate> adjacent_coordinates =
-                get_adjacent(coordinates_check.front(), uint8_t(goboard.get_size()));
-        for (XYCoordinate &element : adjacent_coordinates) {
-            if (goboard.board[element.y][element.x] == 0) {
+    // Coordinates are checked in order, with newly found members appended to the end
+    for (size_t i = 0; i < coordinates_check.size(); i++) {
+        for_each_adjacent(coordinates_check[i], goboard.get_size(), [&](const XYCoordinate &element) {
+            uint8_t element_mask = goboard.board.get(element.x, element.y);
+            if (element_mask == 0) {
                 // If blank, attempt to append to members.
                 // If successful appending to members, add to check list
                 if (i_string.append_member(element)) {
@@ -574,22 +733,17 @@ const GoString GoGame::construct_territory_string(GoString i_string) const {
                     // Check if border has already been found
                     if (first_border == 0) {
                         // If not, set border found and first_border to current piece color
-                        first_border = goboard.board[element.y][element.x];
+                        first_border = element_mask;
                     } else {
                         // If border has already been found, check if piece matches color
-                        if (first_border == goboard.board[element.y][element.x]) {
-                            continue;
-                        } else {
+                        if (first_border != element_mask) {
                             // If it doesn't, we have a neutral territory.
                             neutral_territory = true;
                         }
                     }
                 }
             }
-        }
-
-        // Done checking, remove first element from check list
-        coordinates_check.erase(coordinates_check.begin());
+        });
     }
 
     if (neutral_territory) {
@@ -600,48 +754,74 @@ const GoString GoGame::construct_territory_string(GoString i_string) const {
     return i_string;
 }
 
-const std::array<uint8_t, 2> GoGame::calculate_scores() const {
-    // Get the board size
-    uint8_t board_size = this->get_size();
-    // Get a copy of the board for manipulation.
-    GoBoard scoring_board(goboard);
-    // Create array for storing scores.
-    std::array<uint8_t, 2> scores{ {0, 0} };
+const std::array<GoBitSet, 2> GoGame::calculate_ownership() const {
+    std::array<GoBitSet, 2> ownership;
 
+    // Label each empty region once. A region is owned if it borders stones of only one color.
+    with_go_kernels(this->get_size(), [this, &ownership](auto kernels) {
+        using Kernels = decltype(kernels);
+        const GoBitSet &black = goboard.board.get_stones(0);
+        const GoBitSet &white = goboard.board.get_stones(1);
 
-    // Loop through all board positions. On any empty space, see if it is part of a string that has already been scored.
-    // If not, generate the string and check if it is bordered by only 1 color.
-    for (uint8_t y = 0; y < board_size; y++) {
-        for (uint8_t x = 0; x < board_size; x++) {
-            // First, check if piece has already been scored, or contains a piece
-            if ((scoring_board.board[y][x] & SCORED_MASK) || (scoring_board.board[y][x] & PIECE_MASK)) {
-                continue;
-            }
-            // If we reached here, then the space should be an unscored blank
-            // Generate a string
-            GoString territory_string(uint8_t(goboard.get_size()));
-
-            // Append the piece to the String
-            territory_string.append_member(XYCoordinate(x, y));
-
-            // Complete the string
-            territory_string = this->construct_territory_string(territory_string);
-
-            // Check if the string is owned.
-            if (territory_string.get_border() == get_mask(0)) {
-                // If owned by black, append score to scores[0].
-                scores[0] += territory_string.get_member_count();
-            } else if (territory_string.get_border() == get_mask(1)) {
-                // If owned by white, append score to scores[1].
-                scores[1] += territory_string.get_member_count();
-            }
+        GoBitSet unscored = Kernels::empty_set(black, white);
+        while (unscored.any()) {
+            GoBitSet seed;
+            seed.set(unscored.first());
+            GoBitSet region = Kernels::flood_fill(seed, unscored);
+            unscored = unscored.and_not(region);
 
-            // Mark string members as scored.
-            for (const XYCoordinate &element : territory_string.get_members()) {
-                scoring_board.board[element.y][element.x] = SCORED_MASK;
+            GoBitSet border = Kernels::adjacent_set(region);
+            bool black_border = (border & black).any();
+            bool white_border = (border & white).any();
+            if (black_border != white_border) {
+                ownership[white_border] |= region;
             }
         }
+    });
+
+    return ownership;
+}
+
+// Function to score a position under a scoring method. Specialized per method, so each rule set has its own path.
+template <GoScoring scoring>
+static std::array<double, 2> score_position(const GoBitBoard &i_board, const std::array<GoBitSet, 2> &ownership,
+                                            const std::array<uint8_t, 2> &i_prisoner_count, const double komi);
+
+template <>
+std::array<double, 2> score_position<GoScoring::territory>(const GoBitBoard &i_board,
+                                                           const std::array<GoBitSet, 2> &ownership,
+                                                           const std::array<uint8_t, 2> &i_prisoner_count,
+                                                           const double komi) {
+    // Territory plus prisoners
+    return std::array<double, 2> { {double(ownership[0].count() + i_prisoner_count[0]),
+                                    double(ownership[1].count() + i_prisoner_count[1]) + komi} };
+}
+
+template <>
+std::array<double, 2> score_position<GoScoring::area>(const GoBitBoard &i_board,
+                                                      const std::array<GoBitSet, 2> &ownership,
+                                                      const std::array<uint8_t, 2> &i_prisoner_count,
+                                                      const double komi) {
+    // Territory plus stones on the board
+    return std::array<double, 2> { {double(ownership[0].count() + i_board.get_stones(0).count()),
+                                    double(ownership[1].count() + i_board.get_stones(1).count()) + komi} };
+}
+
+const std::array<double, 2> GoGame::calculate_rule_scores() const {
+    std::array<GoBitSet, 2> ownership = this->calculate_ownership();
+
+    if (rules.scoring == GoScoring::area) {
+        return score_position<GoScoring::area>(goboard.board, ownership, prisoner_count, rules.komi);
+    } else {
+        return score_position<GoScoring::territory>(goboard.board, ownership, prisoner_count, rules.komi);
     }
+}
+
+const std::array<uint8_t, 2> GoGame::calculate_scores() const {
+    // Get territory for each color
+    std::array<GoBitSet, 2> ownership = this->calculate_ownership();
+    // Create array for storing scores.
+    std::array<uint8_t, 2> scores{ {uint8_t(ownership[0].count()), uint8_t(ownership[1].count())} };
 
     // All territories have been calculated. Append prisoners.
     scores[0] += prisoner_count[0];
@@ -6,16 +6,25 @@
 
 #include <algorithm>
 #include <array>
+#include <memory>
 #include <vector>
 #include <unordered_set>
 #include <cstdint>
+#include <cstdlib>
 #include <stdexcept>
 
+#include "gobitboard.h"
+#include "gogamet.h"
+#include "gorules.h"
+#include "gostringtable.h"
+
 #define BLACK_MASK 1
 #define WHITE_MASK 3
 #define PIECE_MASK 1
 #define TEAM_MASK 3
 #define SCORED_MASK 4
+// Key mixed into history hashes of moves made by white under situational superko
+#define GOGAME_SITUATIONAL_KEY 0x9d39247e33776d41ULL
 
 // GoGame exceptions
 class GoBoardInitError : public std::runtime_error {
@@ -38,6 +47,11 @@ public:
     GoBoardBadMask() : std::runtime_error("GoBoardBadMask") { }
 };
 
+class GoBoardBadUndo : public std::runtime_error {
+ public:
+    GoBoardBadUndo() : std::runtime_error("GoBoardBadUndo") { }
+};
+
 // Class for holding x,y coordinates
 class XYCoordinate {
  public:
@@ -81,6 +95,7 @@ inline bool get_piece_bool(const uint8_t mask) {
 
 // Function to get adjacent pieces
 // max = grid size. IE, 8 for an 8x8 grid
+// Allocates the result. Use for_each_adjacent in loops.
 inline std::vector<XYCoordinate> get_adjacent(const XYCoordinate &i_coordinate, uint8_t max) {
     std::vector<XYCoordinate> result;
     // Adjust max for 0 origin
@@ -104,23 +119,34 @@ inline std::vector<XYCoordinate> get_adjacent(const XYCoordinate &i_coordinate,
     return result;
 }
 
+// Function to call function with each piece adjacent to i_coordinate, in the same order as get_adjacent.
+// max = grid size, between 3 and 19. Uses the precomputed neighbour table for the size, so nothing is allocated.
+template <typename Function>
+inline void for_each_adjacent(const XYCoordinate &i_coordinate, const uint8_t max, Function function) {
+    get_go_kernels(max).for_each_adjacent(uint16_t(i_coordinate.y * max + i_coordinate.x),
+                                          [max, &function](const uint16_t index) {
+        function(XYCoordinate(uint8_t(index % max), uint8_t(index / max)));
+    });
+}
+
 // Function to check adjacent pieces
 // max = grid size. IE, 8 for an 8x8 grid
 // Returns true if coordinates are adjacent
 inline bool check_adjacent(const XYCoordinate &i_coordinate_1, const XYCoordinate &i_coordinate_2, uint8_t max) {
-    // Take coordinate_1 and see if coordinate_2 is one of the adjacent grids
-    std::vector<XYCoordinate> adjacent_coordinates = get_adjacent(i_coordinate_1, max);
-
-    return (std::find(adjacent_coordinates.begin(),
-                      adjacent_coordinates.end(), i_coordinate_2) != adjacent_coordinates.end());
+    // coordinate_2 must be on the grid, and exactly one step from coordinate_1 horizontally or vertically
+    if ((i_coordinate_2.x >= max) || (i_coordinate_2.y >= max)) {
+        return false;
+    }
+    int x_distance = std::abs(int(i_coordinate_1.x) - int(i_coordinate_2.x));
+    int y_distance = std::abs(int(i_coordinate_1.y) - int(i_coordinate_2.y));
+    return (x_distance + y_distance) == 1;
 }
 
 // Struct for holding a Go Board
 class GoBoard {
  public:
-    // Go board
-    // TODO(wdfraser): Make this private with [] operator
-    std::vector<std::vector<uint8_t>> board;
+    // Go board. Stones are held in bitsets, board[y][x] access is provided through proxies.
+    GoBitBoard board;
 
     // Constructor with size specification
     explicit GoBoard(const uint8_t board_size);
@@ -205,11 +231,17 @@ class GoString {
 };
 
 // Class for holding a possible move
+// Moves are compact. Moves generated by GoGame share a single copy of the board they were generated from, and the
+// resultant board is only materialized when requested.
 class GoMove {
     friend class GoGame;
  private:
-    // Resultant Game Board
-    GoBoard goboard;
+    // Game board. If deferred is set, this is the board before the piece is placed. Otherwise it is the resultant
+    // board. Shared between copies, and never modified in place.
+    std::shared_ptr<const GoBoard> goboard;
+
+    // Zobrist hash of the resultant board
+    uint64_t hash;
 
     // Piece placed
     XYCoordinate piece;
@@ -220,6 +252,24 @@ class GoMove {
     // Flag to determine if the move is a pass
     bool pass;
 
+    // Flag to determine if placing the piece on goboard has been deferred until the board is requested
+    bool deferred;
+
+    // Color of the piece. Used to place the piece for deferred moves, and to key history under situational superko.
+    // black = 0, white = 1
+    bool color;
+
+    // Pass Constructor sharing an existing board, used by GoGame for generated moves.
+    explicit GoMove(const std::shared_ptr<const GoBoard> &i_goboard);
+
+    // Deferred Constructor, used by GoGame for generated moves.
+    GoMove(const std::shared_ptr<const GoBoard> &i_goboard, const XYCoordinate &i_piece, const bool i_color,
+           const uint8_t i_prisoners_captured, const uint64_t i_hash);
+
+    // Function to place piece on i_goboard for color, capturing and removing suicide strings.
+    // Returns -1 if the point is not empty, otherwise the liberty of the placed string.
+    int place_piece(GoBoard &i_goboard, const bool i_color);
+
  public:
     // Pass Constructor, takes the current board only
     explicit GoMove(const GoBoard &i_goboard);
@@ -246,9 +296,12 @@ class GoMove {
     // black = 0, white = 1
     int check_move(const bool color);
 
-    // Function to get board
+    // Function to get the resultant board. Materializes the board for deferred moves.
     const GoBoard get_board() const;
 
+    // Function to get the Zobrist hash of the resultant board
+    const uint64_t get_hash() const;
+
     // Function to get piece
     const XYCoordinate get_piece() const;
 
@@ -259,18 +312,55 @@ class GoMove {
     const bool check_pass() const;
 };
 
+// Struct for holding the information needed to take back a move made with GoGame::play
+struct GoUndoRecord {
+    // Opponent stones captured by the move
+    GoBitSet captured;
+
+    // Friendly stones removed by a suicide, including the placed stone
+    GoBitSet suicided;
+
+    // Prisoner and pieces placed counts before the move
+    std::array<uint8_t, 2> prisoner_count;
+    std::array<uint8_t, 2> pieces_placed;
+
+    // Point index of the placed stone. Unused for passes.
+    uint16_t index;
+
+    // Color that made the move. black = 0, white = 1
+    bool color;
+
+    // Flag to determine if the move was a pass
+    bool pass;
+};
+
 class GoGame {
  private:
     // Game board
     GoBoard goboard;
 
+    // Rule set
+    GoRules rules;
+
+    // Strings and liberty of the game board, updated incrementally as moves are made
+    GoStringTable strings;
+
     // GoMove list. Cached list of possible moves from current board state.
     std::vector<GoMove> move_list;
 
     // GoMove history
-    // TODO(wdfraser): Let's make this a hash/unordered_set for faster lookup
     std::vector<GoMove> move_history;
 
+    // Zobrist hashes of all board states in move_history, for constant time repeat lookup.
+    // Multiset, as passes can record the same board state more than once.
+    std::unordered_multiset<uint64_t> history_hashes;
+
+    // Flag to determine if history hash matches are confirmed with a full board comparison
+    bool history_verification;
+
+    // Stack of records for moves that can be taken back with undo
+    std::vector<GoUndoRecord> undo_stack;
+
     // Flag to determine if move_list is dirty
     bool move_list_dirty;
 
@@ -285,12 +375,22 @@ class GoGame {
     // Array to hold pieces placed count
     std::array<uint8_t, 2> pieces_placed;
 
+    // Checks if the board state with hash i_hash, reached by color playing at index, has existed before.
+    // The move is only simulated when the hash matches and history verification is enabled.
+    const bool check_hash_history(const uint64_t i_hash, const uint16_t index, const bool color) const;
+
+    // Function to get the history key for a board hash reached by a move of color.
+    // Under situational superko the player to move is part of the key.
+    inline uint64_t get_history_key(const uint64_t i_hash, const bool color) const {
+        return ((rules.superko == GoSuperko::situational) && color) ? (i_hash ^ GOGAME_SITUATIONAL_KEY) : i_hash;
+    }
+
  public:
     // Constructor with size specification
-    explicit GoGame(const uint8_t board_size);
+    explicit GoGame(const uint8_t board_size, const GoRules &i_rules = GoRules());
 
     // Constructor with board passed as a vector
-    explicit GoGame(const GoBoard &i_goboard);
+    explicit GoGame(const GoBoard &i_goboard, const GoRules &i_rules = GoRules());
 
     // Copy Constructor
     GoGame(const GoGame &i_gogame);
@@ -302,9 +402,10 @@ class GoGame {
     const uint8_t get_size() const;
 
     // Function to get current board state
-    const GoBoard get_board() const;
+    const GoBoard &get_board() const;
 
     // Function to set the board. Overrides all checks and should only be used for testing
+    // Clears the undo stack.
     void set_board(const GoBoard &i_goboard);
 
     // Function to get the move list
@@ -313,16 +414,30 @@ class GoGame {
     // Function to get the move history
     const std::vector<GoMove> get_move_history() const;
 
+    // Function to get the Zobrist hash of the current board state
+    const uint64_t get_hash() const;
+
+    // Function to get the rule set
+    const GoRules get_rules() const;
+
+    // Function to enable or disable full board comparison when a move matches a history hash.
+    // Disabled by default, in which case a 64 bit hash collision is treated as a repeat.
+    void set_history_verification(const bool verify);
+
     // Function to get the prisoner counts
     const std::array<uint8_t, 2> get_prisoner_count() const;
 
     // Function to get the pieces placed count
     const std::array<uint8_t, 2> get_pieces_placed() const;
 
-    // Checks if move has been made before
+    // Checks if move has been made before using the history hash set
     // Returns true if board state has previously existed.
     const bool check_move_history(const GoMove &i_move) const;
 
+    // Generate a mask of the points the specified color can legally play, without creating any moves.
+    // Passing is always legal and is not part of the mask. black = 0, white = 1
+    const GoBitSet generate_legal_points(const bool color) const;
+
     // Generate all possible moves for specified color.
     // black = 0, white = 1
     // Return value of 0 signifies no moves.
@@ -332,6 +447,14 @@ class GoGame {
     // Throws GoBoardBadMove exception if move is not valid
     void make_move(const GoMove &i_move, const bool color);
 
+    // Makes a move without validating it, recording it on the undo stack.
+    // Move must be taken from the move list generated for color on the current board state.
+    void play(const GoMove &i_move, const bool color);
+
+    // Takes back the last move made with play or make_move.
+    // Throws GoBoardBadUndo exception if there is no move to take back.
+    void undo();
+
     // Construct a territory string
     const GoString construct_territory_string(GoString i_string) const;
 
@@ -340,6 +463,14 @@ class GoGame {
     // Territory is calculated as a string of empty spaces surrounded by only a single color.
     // Prisoner count is added to territory score.
     const std::array<uint8_t, 2> calculate_scores() const;
+
+    // Function to calculate the territory owned by each color, as a mask of empty points.
+    // ownership[0] = black, ownership[1] = white. Points bordered by both colors, or by none, are in neither.
+    // Each empty region is flood filled once on the bitboard, nothing is allocated.
+    const std::array<GoBitSet, 2> calculate_ownership() const;
+
+    // Function to calculate the score of each color under the game's rule set, including komi for white.
+    const std::array<double, 2> calculate_rule_scores() const;
 };
 
 
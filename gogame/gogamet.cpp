@@ -0,0 +1,22 @@
+// Copyright [2016] <duncan@wduncanfraser.com>
+// Runtime dispatch table for the GoGameT kernels
+
+#include <array>
+#include <cstdint>
+
+#include "gogamet.h"
+
+// Function to build the kernel table entry for board size N
+template <uint8_t N>
+static constexpr GoKernels make_go_kernels() {
+    return GoKernels { N, &GoGameT<N>::adjacent_set, &GoGameT<N>::flood_fill, &GoGameT<N>::empty_set,
+                       GoGameT<N>::neighbours.adjacent, GoGameT<N>::neighbours.count };
+}
+
+const std::array<GoKernels, GOBOARD_MAX_SIZE - 2> go_kernel_table { {
+        make_go_kernels<3>(), make_go_kernels<4>(), make_go_kernels<5>(), make_go_kernels<6>(),
+        make_go_kernels<7>(), make_go_kernels<8>(), make_go_kernels<9>(), make_go_kernels<10>(),
+        make_go_kernels<11>(), make_go_kernels<12>(), make_go_kernels<13>(), make_go_kernels<14>(),
+        make_go_kernels<15>(), make_go_kernels<16>(), make_go_kernels<17>(), make_go_kernels<18>(),
+        make_go_kernels<19>()
+    } };
@@ -0,0 +1,205 @@
+// Copyright [2016] <duncan@wduncanfraser.com>
+// Compile time board size specializations of the rules kernels, with runtime dispatch
+
+#ifndef GOGAME_GOGAMET_H_
+#define GOGAME_GOGAMET_H_
+
+#include <array>
+#include <cstdint>
+
+#include "gobitboard.h"
+
+// Table of the points orthogonally adjacent to each point of an N x N board.
+// Points are indexed in row major order, (y * N) + x. Unused entries are 0.
+template <uint8_t N>
+struct GoNeighbourTable {
+    uint16_t adjacent[N * N][4];
+    uint8_t count[N * N];
+};
+
+// Function to generate the neighbour table for an N x N board at compile time.
+// Neighbours are listed left, right, down, up, matching the order of get_adjacent.
+template <uint8_t N>
+constexpr GoNeighbourTable<N> make_neighbour_table() {
+    GoNeighbourTable<N> result {};
+    for (unsigned int index = 0; index < N * N; index++) {
+        unsigned int x = index % N;
+        uint8_t count = 0;
+        if (x > 0) {
+            result.adjacent[index][count++] = uint16_t(index - 1);
+        }
+        if (x < N - 1u) {
+            result.adjacent[index][count++] = uint16_t(index + 1);
+        }
+        if (index >= N) {
+            result.adjacent[index][count++] = uint16_t(index - N);
+        }
+        if (index + N < N * N) {
+            result.adjacent[index][count++] = uint16_t(index + N);
+        }
+        result.count[index] = count;
+    }
+    return result;
+}
+
+// Word masks for an N x N board, stored in the minimum number of 64 bit words.
+template <uint8_t N>
+struct GoWordMasks {
+    // All points on the board
+    uint64_t board[(N * N + 63) / 64];
+    // Points that have a neighbour to the left (x > 0)
+    uint64_t has_left[(N * N + 63) / 64];
+    // Points that have a neighbour to the right (x < N - 1)
+    uint64_t has_right[(N * N + 63) / 64];
+};
+
+// Function to generate the word masks for an N x N board at compile time
+template <uint8_t N>
+constexpr GoWordMasks<N> make_word_masks() {
+    GoWordMasks<N> result {};
+    for (unsigned int index = 0; index < N * N; index++) {
+        uint64_t bit = uint64_t(1) << (index & 63);
+        result.board[index >> 6] |= bit;
+        if (index % N > 0) {
+            result.has_left[index >> 6] |= bit;
+        }
+        if (index % N < N - 1u) {
+            result.has_right[index >> 6] |= bit;
+        }
+    }
+    return result;
+}
+
+// Rules kernels specialized for an N x N board.
+// Board size, word count, masks and neighbours are all compile time constants, so the loops below only touch the
+// words a board actually uses and can be fully unrolled. Kernels operate on the common GoBitSet storage, so results
+// are interchangeable with the runtime sized functions.
+template <uint8_t N>
+class GoGameT {
+    static_assert((N >= 3) && (N <= GOBOARD_MAX_SIZE), "GoGameT board size must be between 3 and 19");
+
+ public:
+    // Board size, point count and number of bitset words used
+    static constexpr uint8_t size = N;
+    static constexpr uint16_t points = N * N;
+    static constexpr unsigned int words = (N * N + 63) / 64;
+
+    static constexpr GoNeighbourTable<N> neighbours = make_neighbour_table<N>();
+    static constexpr GoWordMasks<N> masks = make_word_masks<N>();
+
+    // Function to get all points orthogonally adjacent to the passed set, excluding points outside the board.
+    static GoBitSet adjacent_set(const GoBitSet &i_bitset) {
+        GoBitSet result;
+        for (unsigned int i = 0; i < words; i++) {
+            uint64_t right = i_bitset.words[i] & masks.has_right[i];
+            uint64_t left = i_bitset.words[i] & masks.has_left[i];
+            uint64_t word = (right << 1) | (left >> 1) | (i_bitset.words[i] << N) | (i_bitset.words[i] >> N);
+            if (i > 0) {
+                word |= ((i_bitset.words[i - 1] & masks.has_right[i - 1]) >> 63);
+                word |= i_bitset.words[i - 1] >> (64 - N);
+            }
+            if (i + 1 < words) {
+                word |= ((i_bitset.words[i + 1] & masks.has_left[i + 1]) << 63);
+                word |= i_bitset.words[i + 1] << (64 - N);
+            }
+            result.words[i] = word & masks.board[i];
+        }
+        return result;
+    }
+
+    // Function to expand seed to all connected points in region. Seed should be a subset of region.
+    static GoBitSet flood_fill(GoBitSet seed, const GoBitSet &region) {
+        while (true) {
+            GoBitSet expanded = adjacent_set(seed);
+            bool changed = false;
+            for (unsigned int i = 0; i < words; i++) {
+                uint64_t word = (expanded.words[i] & region.words[i]) | seed.words[i];
+                changed |= (word != seed.words[i]);
+                seed.words[i] = word;
+            }
+            if (!changed) {
+                return seed;
+            }
+        }
+    }
+
+    // Function to get the empty points of the passed stones
+    static GoBitSet empty_set(const GoBitSet &black, const GoBitSet &white) {
+        GoBitSet result;
+        for (unsigned int i = 0; i < words; i++) {
+            result.words[i] = masks.board[i] & ~(black.words[i] | white.words[i]);
+        }
+        return result;
+    }
+
+    // Function to call function with the index of each point adjacent to index
+    template <typename Function>
+    static inline void for_each_adjacent(const uint16_t index, Function function) {
+        for (uint8_t i = 0; i < neighbours.count[index]; i++) {
+            function(neighbours.adjacent[index][i]);
+        }
+    }
+};
+
+template <uint8_t N> constexpr uint8_t GoGameT<N>::size;
+template <uint8_t N> constexpr uint16_t GoGameT<N>::points;
+template <uint8_t N> constexpr unsigned int GoGameT<N>::words;
+template <uint8_t N> constexpr GoNeighbourTable<N> GoGameT<N>::neighbours;
+template <uint8_t N> constexpr GoWordMasks<N> GoGameT<N>::masks;
+
+// Table of the GoGameT kernels for one board size, selected at runtime.
+// Each call through the table is an indirect call, so loops over many kernel calls should use with_go_kernels.
+struct GoKernels {
+    uint8_t board_size;
+    GoBitSet (*adjacent_set)(const GoBitSet &i_bitset);
+    GoBitSet (*flood_fill)(GoBitSet seed, const GoBitSet &region);
+    GoBitSet (*empty_set)(const GoBitSet &black, const GoBitSet &white);
+
+    // Neighbour table for the board size. Each point has 4 entries, of which the first adjacent_count are valid.
+    const uint16_t (*adjacent)[4];
+    const uint8_t *adjacent_count;
+
+    // Function to call function with the index of each point adjacent to index, without allocating
+    template <typename Function>
+    inline void for_each_adjacent(const uint16_t index, Function function) const {
+        for (uint8_t i = 0; i < adjacent_count[index]; i++) {
+            function(adjacent[index][i]);
+        }
+    }
+};
+
+// Kernels for all board sizes. Index is board size - 3.
+extern const std::array<GoKernels, GOBOARD_MAX_SIZE - 2> go_kernel_table;
+
+// Function to get the kernels for a board size. Size must be between 3 and 19. It is not checked here, as every
+// board size is validated when its GoBitBoard is constructed.
+inline const GoKernels &get_go_kernels(const uint8_t board_size) {
+    return go_kernel_table[board_size - 3];
+}
+
+// Function to call function with GoGameT<N>() for board size N, so the body of function is compiled once per size
+// with the kernels inlined. Size must be between 3 and 19, and is not checked.
+template <typename Function>
+inline auto with_go_kernels(const uint8_t board_size, Function function) -> decltype(function(GoGameT<3>())) {
+    switch (board_size) {
+        case 3: return function(GoGameT<3>());
+        case 4: return function(GoGameT<4>());
+        case 5: return function(GoGameT<5>());
+        case 6: return function(GoGameT<6>());
+        case 7: return function(GoGameT<7>());
+        case 8: return function(GoGameT<8>());
+        case 9: return function(GoGameT<9>());
+        case 10: return function(GoGameT<10>());
+        case 11: return function(GoGameT<11>());
+        case 12: return function(GoGameT<12>());
+        case 13: return function(GoGameT<13>());
+        case 14: return function(GoGameT<14>());
+        case 15: return function(GoGameT<15>());
+        case 16: return function(GoGameT<16>());
+        case 17: return function(GoGameT<17>());
+        case 18: return function(GoGameT<18>());
+        default: return function(GoGameT<19>());
+    }
+}
+
+#endif  // GOGAME_GOGAMET_H_
@@ -0,0 +1,56 @@
+// Copyright [2016] <duncan@wduncanfraser.com>
+// Prototype for GoRules, the rule set configuration used by GoGame
+
+#ifndef GOGAME_GORULES_H_
+#define GOGAME_GORULES_H_
+
+#include <cstdint>
+
+// Scoring method
+enum class GoScoring : uint8_t {
+    // Empty points surrounded by one color plus prisoners. Passing gives the opponent a prisoner.
+    territory,
+    // Stones on the board plus empty points surrounded by one color. Prisoners are ignored.
+    area
+};
+
+// Repeat rule
+enum class GoSuperko : uint8_t {
+    // A move may not recreate any previous board
+    positional,
+    // A move may not recreate any previous board with the same player to move
+    situational
+};
+
+// Struct for holding a rule set. Defaults match the original GoGame rules.
+struct GoRules {
+    // Scoring method
+    GoScoring scoring;
+
+    // Points added to white's score
+    double komi;
+
+    // Repeat rule
+    GoSuperko superko;
+
+    // Flag to determine if moves that leave the placed string without liberty are allowed.
+    // Suicide of a single stone leaves the board unchanged and is never allowed.
+    bool suicide_allowed;
+
+    GoRules() : scoring(GoScoring::territory), komi(0.0), superko(GoSuperko::positional), suicide_allowed(false) { }
+
+    GoRules(const GoScoring i_scoring, const double i_komi, const GoSuperko i_superko, const bool i_suicide_allowed) :
+            scoring(i_scoring), komi(i_komi), superko(i_superko), suicide_allowed(i_suicide_allowed) { }
+
+    // Comparison Operators
+    inline bool operator==(const GoRules &i_rules) const {
+        return (scoring == i_rules.scoring) && (komi == i_rules.komi) && (superko == i_rules.superko) &&
+               (suicide_allowed == i_rules.suicide_allowed);
+    }
+
+    inline bool operator!=(const GoRules &i_rules) const {
+        return !(*this == i_rules);
+    }
+};
+
+#endif  // GOGAME_GORULES_H_
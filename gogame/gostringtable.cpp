@@ -0,0 +1,170 @@
+// Copyright [2016] <duncan@wduncanfraser.com>
+// Implementation of GoStringTable
+
+#include <algorithm>
+#include <array>
+#include <vector>
+#include <cstdint>
+
+#include "gostringtable.h"
+
+GoStringTable::GoStringTable(const GoBitBoard &i_board) : board_size(i_board.size()),
+                                                          kernels(&get_go_kernels(i_board.size())),
+                                                          strings(i_board.size() * i_board.size()) {
+    rebuild(i_board);
+}
+
+template <typename Kernels>
+void GoStringTable::construct_string(const GoBitBoard &i_board, const uint16_t index, const bool color) {
+    GoBitSet seed;
+    seed.set(index);
+    GoBitSet string_members = Kernels::flood_fill(seed, i_board.get_stones(color));
+
+    // index becomes the root for all members
+    string_members.for_each([this, index](const uint16_t member) {
+        parent[member] = index;
+    });
+    strings[index].members = string_members;
+    strings[index].liberties = Kernels::adjacent_set(string_members) &
+                               Kernels::empty_set(i_board.get_stones(0), i_board.get_stones(1));
+}
+
+uint16_t GoStringTable::join(uint16_t root_1, uint16_t root_2) {
+    if (root_1 == root_2) {
+        return root_1;
+    }
+
+    // Attach the smaller string to the larger one, keeping the trees shallow
+    if (strings[root_1].members.count() < strings[root_2].members.count()) {
+        std::swap(root_1, root_2);
+    }
+    parent[root_2] = root_1;
+    strings[root_1].members |= strings[root_2].members;
+    strings[root_1].liberties |= strings[root_2].liberties;
+    return root_1;
+}
+
+void GoStringTable::rebuild(const GoBitBoard &i_board) {
+    for (uint16_t i = 0; i < GOBOARD_MAX_POINTS; i++) {
+        parent[i] = i;
+    }
+    refresh(i_board, get_board_masks(board_size).board);
+}
+
+void GoStringTable::refresh(const GoBitBoard &i_board, const GoBitSet &region) {
+    with_go_kernels(board_size, [&](auto kernels) {
+        this->refresh_t<decltype(kernels)>(i_board, region);
+    });
+}
+
+template <typename Kernels>
+void GoStringTable::refresh_t(const GoBitBoard &i_board, const GoBitSet &region) {
+    for (uint8_t color = 0; color < 2; color++) {
+        GoBitSet pending = i_board.get_stones(color) & region;
+
+        while (pending.any()) {
+            uint16_t index = pending.first();
+            construct_string<Kernels>(i_board, index, color);
+            pending = pending.and_not(strings[index].members);
+        }
+    }
+}
+
+GoMoveEffect GoStringTable::check_move(const GoBitBoard &i_board, const uint16_t index, const bool color) const {
+    GoMoveEffect effect;
+    bool liberty_found = false;
+
+    const GoBitSet &friendly = i_board.get_stones(color);
+    const GoBitSet &enemy = i_board.get_stones(!color);
+
+    kernels->for_each_adjacent(index, [&](const uint16_t adjacent) {
+        if (friendly.test(adjacent)) {
+            // Joining a friendly string keeps its other liberty
+            if (strings[find(adjacent)].liberties.count() > 1) {
+                liberty_found = true;
+            }
+        } else if (enemy.test(adjacent)) {
+            // An enemy string whose only liberty is index is captured
+            uint16_t root = find(adjacent);
+            if (strings[root].liberties.count() == 1) {
+                effect.captured |= strings[root].members;
+            }
+        } else {
+            liberty_found = true;
+        }
+    });
+
+    // Capturing always creates a liberty
+    effect.suicide = !liberty_found && !effect.captured.any();
+
+    // On suicide, the placed stone and every friendly string it joins are removed
+    if (effect.suicide) {
+        effect.suicided.set(index);
+        kernels->for_each_adjacent(index, [&](const uint16_t adjacent) {
+            if (friendly.test(adjacent)) {
+                effect.suicided |= strings[find(adjacent)].members;
+            }
+        });
+    }
+    return effect;
+}
+
+GoMoveEffect GoStringTable::play(GoBitBoard &i_board, const uint16_t index, const bool color) {
+    GoMoveEffect effect = check_move(i_board, index, color);
+
+    // Place the piece as a new string, with empty adjacent points as liberty
+    i_board.place_stone(index, color);
+    parent[index] = index;
+    strings[index].members.clear();
+    strings[index].members.set(index);
+    strings[index].liberties.clear();
+
+    const GoBitSet &friendly = i_board.get_stones(color);
+    const GoBitSet &enemy = i_board.get_stones(!color);
+    const GoBitSet empty = i_board.get_empty();
+
+    kernels->for_each_adjacent(index, [&](const uint16_t adjacent) {
+        if (empty.test(adjacent)) {
+            strings[index].liberties.set(adjacent);
+        }
+    });
+
+    // Join adjacent friendly strings, and remove the point from adjacent enemy liberty
+    uint16_t root = index;
+    kernels->for_each_adjacent(index, [&](const uint16_t adjacent) {
+        if (friendly.test(adjacent)) {
+            root = join(root, find(adjacent));
+        } else if (enemy.test(adjacent)) {
+            strings[find(adjacent)].liberties.reset(index);
+        }
+    });
+    strings[root].liberties.reset(index);
+
+    // Remove a suicided string. Enemy strings adjacent to it gain liberty.
+    if (effect.suicide) {
+        i_board.remove_stones(effect.suicided, color);
+
+        GoBitSet gained = kernels->adjacent_set(effect.suicided) & enemy;
+        while (gained.any()) {
+            uint16_t gained_root = find(gained.first());
+            StringData &gained_string = strings[gained_root];
+            gained_string.liberties |= kernels->adjacent_set(gained_string.members) & effect.suicided;
+            gained = gained.and_not(gained_string.members);
+        }
+    }
+
+    // Remove captured strings. Friendly strings adjacent to them gain liberty.
+    if (effect.captured.any()) {
+        i_board.remove_stones(effect.captured, !color);
+
+        GoBitSet gained = kernels->adjacent_set(effect.captured) & friendly;
+        while (gained.any()) {
+            uint16_t gained_root = find(gained.first());
+            StringData &gained_string = strings[gained_root];
+            gained_string.liberties |= kernels->adjacent_set(gained_string.members) & effect.captured;
+            gained = gained.and_not(gained_string.members);
+        }
+    }
+
+    return effect;
+}
@@ -0,0 +1,102 @@
+// Copyright [2016] <duncan@wduncanfraser.com>
+// Prototype for GoStringTable, incremental tracking of strings and liberties
+
+#ifndef GOGAME_GOSTRINGTABLE_H_
+#define GOGAME_GOSTRINGTABLE_H_
+
+#include <array>
+#include <vector>
+#include <cstdint>
+
+#include "gobitboard.h"
+#include "gogamet.h"
+
+// Struct for holding the effect of placing a stone
+struct GoMoveEffect {
+    // Opponent stones captured by the move
+    GoBitSet captured;
+
+    // Flag to determine if the placed string is left without liberty
+    bool suicide;
+
+    // Friendly stones removed by a suicide, including the placed stone. Empty unless suicide is set.
+    GoBitSet suicided;
+};
+
+// Class for tracking every string on a board along with its liberties.
+// Strings are stored as a union-find over point indexes. Members and liberties are held as bitsets at the root point,
+// so the liberty count of any stone is a lookup rather than a flood fill.
+// Kernels for the board size are selected once, when the table is constructed. Rebuilding strings flood fills every
+// string in the region, so refresh dispatches once per call to a version with the kernels for the size inlined.
+class GoStringTable {
+ private:
+    // Board size
+    uint8_t board_size;
+
+    // Kernels for the board size
+    const GoKernels *kernels;
+
+    // Members and liberty of a string
+    struct StringData {
+        GoBitSet members;
+        GoBitSet liberties;
+    };
+
+    // Parent point of each stone. A string's root point is its own parent. Entries for empty points are unused.
+    std::array<uint16_t, GOBOARD_MAX_POINTS> parent;
+
+    // Members and liberty of each string, valid at the root point. Sized board_size * board_size, and held in one
+    // allocation, so copying the table with its game copies one block.
+    std::vector<StringData> strings;
+
+    // Function to construct the string containing the stone at index from scratch
+    template <typename Kernels>
+    void construct_string(const GoBitBoard &i_board, const uint16_t index, const bool color);
+
+    // Function to refresh strings in region with the GoGameT kernels of the board size
+    template <typename Kernels>
+    void refresh_t(const GoBitBoard &i_board, const GoBitSet &region);
+
+    // Function to join the strings with roots root_1 and root_2. Returns the root of the joined string.
+    uint16_t join(uint16_t root_1, uint16_t root_2);
+
+ public:
+    // Constructor building the table for an existing board
+    explicit GoStringTable(const GoBitBoard &i_board);
+
+    // Function to rebuild the whole table from the board
+    void rebuild(const GoBitBoard &i_board);
+
+    // Function to rebuild every string with a member in region from the board.
+    // Strings without a member in region must be unchanged since the table was last updated.
+    void refresh(const GoBitBoard &i_board, const GoBitSet &region);
+
+    // Function to get the root point of the string containing the stone at index
+    inline uint16_t find(uint16_t index) const {
+        while (parent[index] != index) {
+            index = parent[index];
+        }
+        return index;
+    }
+
+    // Function to get the members of the string containing the stone at index
+    inline const GoBitSet &get_members(const uint16_t index) const {
+        return strings[find(index)].members;
+    }
+
+    // Function to get the liberty of the string containing the stone at index
+    inline const GoBitSet &get_liberty(const uint16_t index) const {
+        return strings[find(index)].liberties;
+    }
+
+    // Function to determine the effect of color placing a stone on the empty point at index, without changing the
+    // board. black = 0, white = 1
+    GoMoveEffect check_move(const GoBitBoard &i_board, const uint16_t index, const bool color) const;
+
+    // Function to place a stone of color on the empty point at index, removing captured opponent strings from the
+    // board and updating the table. If the move is suicide, the placed string is removed as well.
+    // Returns the effect of the move. black = 0, white = 1
+    GoMoveEffect play(GoBitBoard &i_board, const uint16_t index, const bool color);
+};
+
+#endif  // GOGAME_GOSTRINGTABLE_H_
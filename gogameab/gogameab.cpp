@@ -11,44 +11,242 @@
 #include "gogameab.h"
 
 
-double scalable_go_ab_prune(GoGameNN &network, GoGame &i_gogame, const int depth, double alpha, double beta,
-                            const bool move_color, const bool max_player, const bool player_color) {
+// Function to search a node for the network overloads of scalable_go_ab_prune. A null table searches without one.
+static double ab_prune_node(GoGameNN &network, GoGame &i_gogame, const int depth, double alpha, const double beta,
+                            const bool move_color, const bool player_color, GoTranspositionTable *table,
+                            GoTranspositionStats *stats);
+
+double scalable_go_ab_prune(GoGameNN &network, GoGame &i_gogame, const int depth, double alpha, const double beta,
+                            const bool move_color, const bool player_color) {
+    return ab_prune_node(network, i_gogame, depth, alpha, beta, move_color, player_color, nullptr, nullptr);
+}
+
+double scalable_go_ab_prune(GoGameNNEvaluator &evaluator, GoGame &i_gogame, const int depth, double alpha,
+                            const double beta, const bool move_color) {
+    const double sign = get_side_sign(move_color, evaluator.get_color());
+
+    // If this is the depth limit, evaluate the windows as they stand
+    if (depth <= 0) {
+        return sign * evaluator.evaluate();
+    }
+
+    // Generate moves and retrieve the move list
+    i_gogame.generate_moves(move_color);
+    std::vector<GoMove> current_move_list = i_gogame.get_move_list();
+
+    if (current_move_list.size() <= 0) {
+        return sign * evaluator.evaluate();
+    }
+
+    for (GoMove &element : current_move_list) {
+        // Make the move in place, search, and take it back
+        i_gogame.play(element, move_color);
+        evaluator.update();
+        double value = -scalable_go_ab_prune(evaluator, i_gogame, depth - 1, -beta, -alpha, !move_color);
+        i_gogame.undo();
+        evaluator.rollback();
+
+        alpha = std::max(alpha, value);
+        if (alpha >= beta) {
+            break;
+        }
+    }
+    return alpha;
+}
+
+// Function to get the bound of a fail hard search result, given the window it was searched with
+static inline GoBound get_result_bound(const double value, const double alpha, const double beta) {
+    if (value <= alpha) {
+        return GoBound::upper;
+    } else if (value >= beta) {
+        return GoBound::lower;
+    }
+    return GoBound::exact;
+}
+
+bool probe_side_entry(GoTranspositionTable &table, const uint64_t key, const double sign,
+                      GoTranspositionEntry &entry, GoTranspositionStats *stats) {
+    if (!table.probe(key, entry, stats)) {
+        return false;
+    }
+    // A bound on the value for the opponent of player_color is the opposite bound for player_color
+    if (sign < 0) {
+        entry.value = -entry.value;
+        if (entry.bound == GoBound::lower) {
+            entry.bound = GoBound::upper;
+        } else if (entry.bound == GoBound::upper) {
+            entry.bound = GoBound::lower;
+        }
+    }
+    return true;
+}
+
+void store_side_entry(GoTranspositionTable &table, const uint64_t key, const double sign, const int depth,
+                      GoBound bound, const double value, const uint16_t best_move, GoTranspositionStats *stats) {
+    if ((sign < 0) && (bound != GoBound::exact)) {
+        bound = (bound == GoBound::lower) ? GoBound::upper : GoBound::lower;
+    }
+    table.store(key, depth, bound, sign * value, best_move, stats);
+}
+
+size_t scalable_go_evaluate_children(GoGameNN &network, GoGame &i_gogame, const std::vector<GoMove> &move_list,
+                                     const bool move_color, const bool player_color, GoTranspositionTable &table,
+                                     std::vector<double> &values, const size_t first, const size_t last,
+                                     GoTranspositionStats *stats) {
+    // Kept per thread, so leaf batches stop allocating once grown
+    static thread_local GoGameNNBatch leaf_batch;
+    static thread_local std::vector<uint64_t> child_keys;
+    static thread_local std::vector<size_t> missed;
+    const size_t count = std::min(last, move_list.size()) - std::min(first, move_list.size());
+    leaf_batch.clear(i_gogame.get_size());
+    values.assign(count, 0);
+    child_keys.assign(count, 0);
+    missed.clear();
+
+    GoTranspositionEntry entry;
+    for (size_t i = 0; i < count; i++) {
+        i_gogame.play(move_list[first + i], move_color);
+        child_keys[i] = get_search_key(i_gogame, !move_color, player_color);
+        if (table.probe(child_keys[i], entry, stats) && (entry.bound == GoBound::exact)) {
+            values[i] = entry.value;
+        } else {
+            leaf_batch.add_position(i_gogame, player_color);
+            missed.push_back(i);
+        }
+        i_gogame.undo();
+    }
+
+    if (missed.size() > 0) {
+        network.feed_forward_batch(leaf_batch);
+        const std::vector<double> &batch_output = network.get_batch_output();
+        for (size_t i = 0; i < missed.size(); i++) {
+            values[missed[i]] = batch_output[i];
+            table.store(child_keys[missed[i]], 0, GoBound::exact, batch_output[i], GOTT_MOVE_NONE, stats);
+        }
+    }
+    return missed.size();
+}
+
+double scalable_go_ab_prune(GoGameNN &network, GoGame &i_gogame, const int depth, double alpha, const double beta,
+                            const bool move_color, const bool player_color, GoTranspositionTable &table,
+                            GoTranspositionStats *stats) {
+    return ab_prune_node(network, i_gogame, depth, alpha, beta, move_color, player_color, &table, stats);
+}
+
+static double ab_prune_node(GoGameNN &network, GoGame &i_gogame, const int depth, double alpha, const double beta,
+                            const bool move_color, const bool player_color, GoTranspositionTable *table,
+                            GoTranspositionStats *stats) {
+    const uint8_t board_size = i_gogame.get_size();
+    const double sign = get_side_sign(move_color, player_color);
+    const uint64_t key = (table != nullptr) ? get_search_key(i_gogame, move_color, player_color) : 0;
+
+    // Answer from the table if the position was searched at least as deep, and the result decides this window
+    GoTranspositionEntry entry;
+    uint16_t hash_move = GOTT_MOVE_NONE;
+    if ((table != nullptr) && probe_side_entry(*table, key, sign, entry, stats)) {
+        if (entry.depth >= depth) {
+            if (entry.bound == GoBound::exact) {
+                return entry.value;
+            } else if ((entry.bound == GoBound::lower) && (entry.value >= beta)) {
+                return beta;
+            } else if ((entry.bound == GoBound::upper) && (entry.value <= alpha)) {
+                return alpha;
+            }
+        }
+        hash_move = entry.best_move;
+    }
+
     // Generate moves and retrieve the move list
     i_gogame.generate_moves(move_color);
     std::vector<GoMove> current_move_list = i_gogame.get_move_list();
 
     // If this is the depth limit, or a leaf, calculate and return
-    if ((depth <= 0) || (current_move_list.size() <=0 )) {
-        std::vector<std::vector<double>> network_translation = get_go_network_translation(i_gogame, player_color);
-
-        network.feed_forward(network_translation, i_gogame.get_pieces_placed()[player_color],
-                             i_gogame.get_prisoner_count()[player_color], i_gogame.get_prisoner_count()[!player_color]);
-        return network.get_output();
-    }
-
-    if (max_player) {
-        for (GoMove &element : current_move_list) {
-            // Duplicate the existing board and make the move
-            GoGame temp_board(i_gogame);
-            temp_board.make_move(element, move_color);
-            alpha = std::max(alpha, scalable_go_ab_prune(network, temp_board, depth-1, alpha, beta, !move_color,
-                                                    false, player_color));
-            if (beta <= alpha) {
+    if ((depth <= 0) || (current_move_list.size() <= 0)) {
+        network.feed_forward(i_gogame, player_color);
+        double value = sign * network.get_output();
+        if (table != nullptr) {
+            store_side_entry(*table, key, sign, std::max(depth, 0), GoBound::exact, value, GOTT_MOVE_NONE, stats);
+        }
+        return value;
+    }
+
+    const double original_alpha = alpha;
+    uint16_t best_move = GOTT_MOVE_NONE;
+
+    if (depth == 1) {
+        // The children are leaves, evaluated together as one batch, then folded in move order so the result matches
+        // searching them one at a time. Kept per thread, so leaf batches stop allocating once grown.
+        static thread_local GoGameNNBatch leaf_batch;
+        static thread_local std::vector<double> child_values;
+        if (table != nullptr) {
+            scalable_go_evaluate_children(network, i_gogame, current_move_list, move_color, player_color, *table,
+                                          child_values, 0, current_move_list.size(), stats);
+        } else {
+            leaf_batch.clear(board_size);
+            for (GoMove &element : current_move_list) {
+                i_gogame.play(element, move_color);
+                leaf_batch.add_position(i_gogame, player_color);
+                i_gogame.undo();
+            }
+            network.feed_forward_batch(leaf_batch);
+        }
+        const std::vector<double> &values = (table != nullptr) ? child_values : network.get_batch_output();
+
+        for (size_t i = 0; i < current_move_list.size(); i++) {
+            const double value = sign * values[i];
+            if (value > alpha) {
+                alpha = value;
+                best_move = get_move_code(current_move_list[i], board_size);
+            }
+            if (alpha >= beta) {
                 break;
             }
         }
-        return alpha;
     } else {
-        for (GoMove &element : current_move_list) {
-            // Duplicate the existing board and make the move
-            GoGame temp_board(i_gogame);
-            temp_board.make_move(element, move_color);
-            beta = std::min(beta, scalable_go_ab_prune(network, temp_board, depth-1, alpha, beta, !move_color,
-                                                  true, player_color));
-            if (beta <= alpha) {
+        // Search the best move from the table first
+        if (hash_move != GOTT_MOVE_NONE) {
+            for (auto it = current_move_list.begin(); it != current_move_list.end(); ++it) {
+                if (get_move_code(*it, board_size) == hash_move) {
+                    std::rotate(current_move_list.begin(), it, it + 1);
+                    break;
+                }
+            }
+        }
+
+        for (size_t i = 0; i < current_move_list.size(); i++) {
+            // Make the move in place, search, and take it back
+            const GoMove &element = current_move_list[i];
+            i_gogame.play(element, move_color);
+            double value;
+            if ((i == 0) || (table == nullptr) || (depth == 2)) {
+                // Null windows only pay when the first move is likely the best, so unordered searches use the full
+                // window. Children of depth 1 evaluate all their leaves as one batch whatever the window.
+                value = -ab_prune_node(network, i_gogame, depth - 1, -beta, -alpha, !move_color, player_color, table,
+                                       stats);
+            } else {
+                // Prove the move is no better than alpha with a null window, and search it fully only if that fails
+                value = -ab_prune_node(network, i_gogame, depth - 1, -std::nextafter(alpha, beta), -alpha,
+                                       !move_color, player_color, table, stats);
+                if ((value > alpha) && (value < beta)) {
+                    value = -ab_prune_node(network, i_gogame, depth - 1, -beta, -alpha, !move_color, player_color,
+                                           table, stats);
+                }
+            }
+            i_gogame.undo();
+
+            if (value > alpha) {
+                alpha = value;
+                best_move = get_move_code(element, board_size);
+            }
+            if (alpha >= beta) {
                 break;
             }
         }
-        return beta;
     }
+
+    if (table != nullptr) {
+        store_side_entry(*table, key, sign, depth, get_result_bound(alpha, original_alpha, beta), alpha, best_move,
+                         stats);
+    }
+    return alpha;
 }
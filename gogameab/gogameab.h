@@ -5,14 +5,62 @@
 #define GOGAMEAB_GOGAMEAB_H_
 
 #include <stdexcept>
+#include <vector>
+#include <limits>
+#include <cstdint>
 
 #include "gogamenn.h"
+#include "gogamennevaluator.h"
 #include "gogame.h"
+#include "gotranspositiontable.h"
 
 // ABPrune exceptions
 
-// Alpha Beta Pruning algorithm for Go move generation
-double scalable_go_ab_prune(GoGameNN &network, GoGame &i_gogame, const int depth, double alpha, double beta,
-                            const bool move_color, const bool max_player, const bool player_color);
+// Function to get the sign converting values for player_color to values for move_color
+inline double get_side_sign(const bool move_color, const bool player_color) {
+    return (move_color == player_color) ? 1 : -1;
+}
+
+// Alpha Beta Pruning algorithm for Go move generation, as a negamax search
+// Returns the value of i_gogame for move_color, the network evaluation for player_color negated when move_color is
+// the opponent. The result is exact inside the window. At or below alpha it is only an upper bound, and at or above
+// beta only a lower bound: positions searched further return alpha when no move beats it, but leaves and exact table
+// entries return their value unclamped. A move is scored by the caller as the negated search of the position after
+// it, with the window negated and swapped. Moves are made and taken back in place on i_gogame, which is returned to
+// its original state.
+double scalable_go_ab_prune(GoGameNN &network, GoGame &i_gogame, const int depth, double alpha, const double beta,
+                            const bool move_color, const bool player_color);
+
+// Alpha Beta Pruning algorithm using an incremental evaluator bound to i_gogame. The player color is the evaluator
+// color. The evaluator is updated after each move and rolled back after each undo, so leaves only recompute the
+// windows the moves changed.
+double scalable_go_ab_prune(GoGameNNEvaluator &evaluator, GoGame &i_gogame, const int depth, double alpha,
+                            const double beta, const bool move_color);
+
+// Function to evaluate the position after each move of move_list from first up to last, made by move_color, for
+// player_color. Positions found in table are taken from it, and the rest are evaluated as one batch and stored.
+// values holds one value per move evaluated. Table use is counted in stats, if not null. Returns the number of
+// network evaluations.
+size_t scalable_go_evaluate_children(GoGameNN &network, GoGame &i_gogame, const std::vector<GoMove> &move_list,
+                                     const bool move_color, const bool player_color, GoTranspositionTable &table,
+                                     std::vector<double> &values, const size_t first = 0,
+                                     const size_t last = std::numeric_limits<size_t>::max(),
+                                     GoTranspositionStats *stats = nullptr);
+
+// Functions to probe and store table with values for the side to move. The table holds values for player_color, so
+// values and bounds are converted with sign, from get_side_sign. Table use is counted in stats, if not null.
+bool probe_side_entry(GoTranspositionTable &table, const uint64_t key, const double sign,
+                      GoTranspositionEntry &entry, GoTranspositionStats *stats);
+void store_side_entry(GoTranspositionTable &table, const uint64_t key, const double sign, const int depth,
+                      GoBound bound, const double value, const uint16_t best_move, GoTranspositionStats *stats);
+
+// Alpha Beta Pruning algorithm sharing results through a transposition table, as a negamax principal variation search.
+// Positions already searched to at least depth are answered from the table, and the best move stored for a position
+// is searched first, with the full window. Later moves are searched with a null window, and searched again only if
+// they fail high. The table may be shared between threads, but must only hold results of network for player_color.
+// Table use is counted in stats, if not null, which should be kept per thread.
+double scalable_go_ab_prune(GoGameNN &network, GoGame &i_gogame, const int depth, double alpha, const double beta,
+                            const bool move_color, const bool player_color, GoTranspositionTable &table,
+                            GoTranspositionStats *stats = nullptr);
 
 #endif  // GOGAMEAB_GOGAMEAB_H_
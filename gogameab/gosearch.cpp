@@ -0,0 +1,498 @@
+// Copyright [2016] <duncan@wduncanfraser.com>
+// Implementation of GoSearch
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include <limits>
+#include <cmath>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "gosearch.h"
+#include "gogameab.h"
+
+GoSearch::GoSearch(GoGameNN &i_network, const size_t table_size_mb, const unsigned int i_thread_count) :
+        network(i_network), table(table_size_mb), thread_count(std::max(i_thread_count, 1u)), nodes(0),
+        stop(false) { }
+
+bool GoSearch::check_limits(Worker &worker) {
+    nodes.fetch_add(worker.pending_nodes, std::memory_order_relaxed);
+    worker.pending_nodes = 0;
+
+    bool limit_reached = stop.load(std::memory_order_relaxed) ||
+                         ((limits.max_nodes > 0) && (nodes.load(std::memory_order_relaxed) >= limits.max_nodes));
+    if (!limit_reached && (limits.max_time > 0)) {
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_time;
+        limit_reached = elapsed.count() >= limits.max_time;
+    }
+    if (limit_reached && worker.abortable) {
+        worker.aborted = true;
+    }
+    return limit_reached;
+}
+
+bool GoSearch::count_nodes(Worker &worker, const uint64_t count) {
+    worker.pending_nodes += count;
+    if ((worker.pending_nodes < GOSEARCH_CHECK_INTERVAL) && !stop.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    return check_limits(worker);
+}
+
+void GoSearch::move_to_front(std::vector<GoMove> &move_list, const uint16_t code, const uint8_t board_size) {
+    if (code == GOTT_MOVE_NONE) {
+        return;
+    }
+    for (auto it = move_list.begin(); it != move_list.end(); ++it) {
+        if (get_move_code(*it, board_size) == code) {
+            std::rotate(move_list.begin(), it, it + 1);
+            return;
+        }
+    }
+}
+
+void GoSearch::order_moves(Worker &worker, std::vector<GoMove> &move_list, const size_t ply, const bool move_color,
+                           const uint16_t pv_move, const uint16_t hash_move, const uint8_t board_size) {
+    // Scores above any history score, for the principal variation, table and killer moves
+    const uint64_t pv_score = std::numeric_limits<uint64_t>::max();
+    const uint64_t hash_score = pv_score - 1;
+    const uint64_t killer_score = hash_score - 1;
+
+    worker.order_scores.resize(move_list.size());
+    for (size_t i = 0; i < move_list.size(); i++) {
+        const uint16_t code = get_move_code(move_list[i], board_size);
+        uint64_t score = 0;
+        if (code == pv_move) {
+            score = pv_score;
+        } else if (code == hash_move) {
+            score = hash_score;
+        } else {
+            for (size_t slot = 0; slot < GOSEARCH_KILLER_SLOTS; slot++) {
+                if (worker.killers[ply][slot] == code) {
+                    score = killer_score - slot;
+                    break;
+                }
+            }
+            if ((score == 0) && (code != GOTT_MOVE_PASS)) {
+                score = worker.history[move_color][code];
+            }
+        }
+        worker.order_scores[i] = std::make_pair(score, i);
+    }
+
+    std::stable_sort(worker.order_scores.begin(), worker.order_scores.end(),
+                     [](const std::pair<uint64_t, size_t> &a, const std::pair<uint64_t, size_t> &b) {
+        return a.first > b.first;
+    });
+
+    std::vector<GoMove> sorted_list;
+    sorted_list.reserve(move_list.size());
+    for (const std::pair<uint64_t, size_t> &element : worker.order_scores) {
+        sorted_list.push_back(move_list[element.second]);
+    }
+    move_list.swap(sorted_list);
+}
+
+void GoSearch::record_cutoff(Worker &worker, const uint16_t code, const size_t ply, const bool move_color,
+                             const int depth) {
+    // Passes and missing moves have no point to score
+    if (code >= worker.history[move_color].size()) {
+        return;
+    }
+
+    // Push the move into the first killer slot, unless it is already there
+    std::array<uint16_t, GOSEARCH_KILLER_SLOTS> &ply_killers = worker.killers[ply];
+    if (ply_killers[0] != code) {
+        for (size_t slot = GOSEARCH_KILLER_SLOTS - 1; slot > 0; slot--) {
+            ply_killers[slot] = ply_killers[slot - 1];
+        }
+        ply_killers[0] = code;
+    }
+
+    // Deeper cut offs save more work, so count for more. Halve the table on saturation, so old cut offs decay.
+    std::vector<uint32_t> &color_history = worker.history[move_color];
+    color_history[code] += uint32_t(depth * depth);
+    if (color_history[code] > GOSEARCH_HISTORY_MAX) {
+        for (uint32_t &score : color_history) {
+            score /= 2;
+        }
+    }
+}
+
+double GoSearch::search_child(Worker &worker, const GoMove &move, const int depth, const size_t ply,
+                              const double alpha, const double beta, const bool move_color, const bool player_color,
+                              const bool first, const bool on_pv) {
+    GoGame &i_gogame = *worker.gogame;
+    i_gogame.play(move, move_color);
+    double value;
+    if (first) {
+        value = -search_node(worker, depth - 1, ply + 1, -beta, -alpha, !move_color, player_color, on_pv);
+    } else {
+        // Prove the move is no better than alpha with a null window, and search it fully only if that fails
+        value = -search_node(worker, depth - 1, ply + 1, -std::nextafter(alpha, beta), -alpha, !move_color,
+                             player_color, on_pv);
+        if ((value > alpha) && (value < beta) && !worker.aborted) {
+            worker.researches++;
+            value = -search_node(worker, depth - 1, ply + 1, -beta, -alpha, !move_color, player_color, on_pv);
+        }
+    }
+    i_gogame.undo();
+    return value;
+}
+
+double GoSearch::search_node(Worker &worker, const int depth, const size_t ply, double alpha, const double beta,
+                             const bool move_color, const bool player_color, const bool on_pv) {
+    worker.pv_table[ply].clear();
+    if (count_nodes(worker, 1) && worker.aborted) {
+        return 0;
+    }
+
+    GoGame &i_gogame = *worker.gogame;
+    const uint8_t board_size = i_gogame.get_size();
+    const uint64_t key = get_search_key(i_gogame, move_color, player_color);
+    const double sign = get_side_sign(move_color, player_color);
+
+    // Answer from the table if the position was searched at least as deep, and the result decides this window
+    GoTranspositionEntry entry;
+    uint16_t hash_move = GOTT_MOVE_NONE;
+    if (probe_side_entry(table, key, sign, entry, &worker.table_stats)) {
+        if (entry.depth >= depth) {
+            if (entry.bound == GoBound::exact) {
+                return entry.value;
+            } else if ((entry.bound == GoBound::lower) && (entry.value >= beta)) {
+                return beta;
+            } else if ((entry.bound == GoBound::upper) && (entry.value <= alpha)) {
+                return alpha;
+            }
+        }
+        hash_move = entry.best_move;
+    }
+
+    // Generate moves and retrieve the move list
+    i_gogame.generate_moves(move_color);
+    std::vector<GoMove> current_move_list = i_gogame.get_move_list();
+
+    // If this is the depth limit, or a leaf, calculate and return
+    if ((depth <= 0) || (current_move_list.size() <= 0)) {
+        worker.network->feed_forward(i_gogame, player_color);
+        double value = sign * worker.network->get_output();
+        store_side_entry(table, key, sign, std::max(depth, 0), GoBound::exact, value, GOTT_MOVE_NONE,
+                         &worker.table_stats);
+        return value;
+    }
+
+    const double original_alpha = alpha;
+    uint16_t best_move = GOTT_MOVE_NONE;
+
+    uint16_t pv_move = GOTT_MOVE_NONE;
+    if (on_pv && (ply < worker.previous_pv.size())) {
+        pv_move = get_move_code(worker.previous_pv[ply], board_size);
+    }
+    order_moves(worker, current_move_list, ply, move_color, pv_move, hash_move, board_size);
+
+    if (depth == 1) {
+        // Children are leaves, evaluated in batches in move order, until one cuts off
+        static thread_local std::vector<double> child_values;
+        for (size_t first = 0; (first < current_move_list.size()) && (alpha < beta); first += GOSEARCH_LEAF_BATCH) {
+            worker.pending_nodes += scalable_go_evaluate_children(*worker.network, i_gogame, current_move_list,
+                                                                  move_color, player_color, table, child_values,
+                                                                  first, first + GOSEARCH_LEAF_BATCH,
+                                                                  &worker.table_stats);
+
+            for (size_t i = 0; i < child_values.size(); i++) {
+                const double value = sign * child_values[i];
+                if (value > alpha) {
+                    alpha = value;
+                    best_move = get_move_code(current_move_list[first + i], board_size);
+                    worker.pv_table[ply].assign(1, current_move_list[first + i]);
+                }
+                if (alpha >= beta) {
+                    worker.cutoffs++;
+                    if (first + i == 0) {
+                        worker.first_move_cutoffs++;
+                    }
+                    record_cutoff(worker, best_move, ply, move_color, depth);
+                    break;
+                }
+            }
+        }
+    } else {
+        for (size_t i = 0; i < current_move_list.size(); i++) {
+            const GoMove &element = current_move_list[i];
+            const uint16_t code = get_move_code(element, board_size);
+            double value = search_child(worker, element, depth, ply, alpha, beta, move_color, player_color, i == 0,
+                                        on_pv && (code == pv_move));
+            if (worker.aborted) {
+                return 0;
+            }
+
+            if (value > alpha) {
+                alpha = value;
+                best_move = code;
+                worker.pv_table[ply].assign(1, element);
+                worker.pv_table[ply].insert(worker.pv_table[ply].end(), worker.pv_table[ply + 1].begin(),
+                                            worker.pv_table[ply + 1].end());
+            }
+            if (alpha >= beta) {
+                worker.cutoffs++;
+                if (i == 0) {
+                    worker.first_move_cutoffs++;
+                }
+                record_cutoff(worker, code, ply, move_color, depth);
+                break;
+            }
+        }
+    }
+
+    GoBound bound = GoBound::exact;
+    if (alpha <= original_alpha) {
+        bound = GoBound::upper;
+    } else if (alpha >= beta) {
+        bound = GoBound::lower;
+    }
+    store_side_entry(table, key, sign, depth, bound, alpha, best_move, &worker.table_stats);
+    return alpha;
+}
+
+void GoSearch::search_thread(Worker &worker, const unsigned int thread, const bool color) {
+    GoGame &i_gogame = *worker.gogame;
+    const uint8_t board_size = i_gogame.get_size();
+    const int max_depth = std::max(limits.max_depth, 1);
+
+    i_gogame.generate_moves(color);
+    std::vector<GoMove> root_move_list = i_gogame.get_move_list();
+    if (root_move_list.size() <= 0) {
+        return;
+    }
+
+    // Helpers may always be stopped. Odd helpers skip the first iteration, so they run a ply ahead.
+    worker.abortable = thread > 0;
+    const int start_depth = ((thread % 2) == 1) ? std::min(2, max_depth) : 1;
+
+    std::vector<double> values;
+    for (int depth = start_depth; depth <= max_depth; depth++) {
+        // A helper started after the main thread finished has nothing to add
+        if ((thread > 0) && stop.load(std::memory_order_relaxed)) {
+            break;
+        }
+        // Only the first iteration of the main thread must complete
+        if (thread == 0) {
+            worker.abortable = depth > 1;
+        }
+
+        double alpha = -std::numeric_limits<double>::infinity();
+        size_t best_index = 0;
+        std::vector<GoMove> pv;
+
+        if (depth == 1) {
+            worker.pending_nodes += 1 + scalable_go_evaluate_children(*worker.network, i_gogame, root_move_list,
+                                                                      color, color, table, values, 0,
+                                                                      root_move_list.size(), &worker.table_stats);
+            for (size_t i = 0; i < root_move_list.size(); i++) {
+                if ((i == 0) || (values[i] > alpha)) {
+                    alpha = values[i];
+                    best_index = i;
+                }
+            }
+            pv.assign(1, root_move_list[best_index]);
+        } else {
+            // Search the best move of the previous iteration first. Helpers rotate the rest by their index, so
+            // threads start on different subtrees.
+            if (worker.previous_pv.size() > 0) {
+                move_to_front(root_move_list, get_move_code(worker.previous_pv[0], board_size), board_size);
+            }
+            if ((thread > 0) && (root_move_list.size() > 2)) {
+                std::rotate(root_move_list.begin() + 1,
+                            root_move_list.begin() + 1 + (thread % (root_move_list.size() - 1)),
+                            root_move_list.end());
+            }
+
+            // Search a window around the value of the previous iteration. If the value falls outside, open that
+            // side of the window and search again.
+            double window_alpha = -std::numeric_limits<double>::infinity();
+            double window_beta = std::numeric_limits<double>::infinity();
+            if (worker.depth > 0) {
+                window_alpha = worker.value - GOSEARCH_ASPIRATION_WINDOW;
+                window_beta = worker.value + GOSEARCH_ASPIRATION_WINDOW;
+            }
+
+            while (true) {
+                worker.pending_nodes++;
+                alpha = window_alpha;
+                best_index = 0;
+                pv.clear();
+
+                for (size_t i = 0; i < root_move_list.size(); i++) {
+                    double value = search_child(worker, root_move_list[i], depth, 0, alpha, window_beta, color,
+                                                color, i == 0, (i == 0) && (worker.previous_pv.size() > 0));
+                    if (worker.aborted) {
+                        break;
+                    }
+
+                    if ((value > alpha) || (pv.size() == 0)) {
+                        alpha = std::max(alpha, value);
+                        best_index = i;
+                        pv.assign(1, root_move_list[i]);
+                        pv.insert(pv.end(), worker.pv_table[1].begin(), worker.pv_table[1].end());
+                    }
+                    if (alpha >= window_beta) {
+                        break;
+                    }
+                }
+
+                if (worker.aborted) {
+                    break;
+                } else if (alpha <= window_alpha) {
+                    window_alpha = -std::numeric_limits<double>::infinity();
+                } else if (alpha >= window_beta) {
+                    window_beta = std::numeric_limits<double>::infinity();
+                } else {
+                    break;
+                }
+                worker.researches++;
+            }
+        }
+
+        // Abandon an unfinished iteration, keeping the result of the last completed one
+        if (worker.aborted) {
+            break;
+        }
+
+        table.store(get_search_key(i_gogame, color, color), depth, GoBound::exact, alpha,
+                    get_move_code(root_move_list[best_index], board_size), &worker.table_stats);
+        worker.depth = depth;
+        worker.value = alpha;
+        worker.principal_variation = pv;
+        worker.previous_pv = pv;
+
+        if (check_limits(worker)) {
+            break;
+        }
+    }
+
+    // Add the nodes of an abandoned iteration
+    nodes.fetch_add(worker.pending_nodes, std::memory_order_relaxed);
+    worker.pending_nodes = 0;
+}
+
+GoSearchResult GoSearch::search(GoGame &i_gogame, const bool color, const GoSearchLimits &i_limits) {
+    limits = i_limits;
+    start_time = std::chrono::steady_clock::now();
+    nodes = 0;
+    stop = false;
+    table.new_search();
+
+    GoSearchResult result(i_gogame.get_board());
+    const uint8_t board_size = i_gogame.get_size();
+
+    // A search started inside a parallel region, such as a game of the training or comparison match loops, runs on
+    // one worker rather than nesting a team of threads under each caller thread
+    unsigned int active_threads = thread_count;
+#ifdef _OPENMP
+    if (omp_in_parallel()) {
+        active_threads = 1;
+    }
+#endif
+
+    // Helpers search copies of the game and network. The network copies share their weights.
+    std::vector<std::unique_ptr<GoGame>> helper_games;
+    helper_networks.clear();
+    helper_networks.reserve(active_threads - 1);
+    workers.resize(active_threads);
+    for (unsigned int thread = 0; thread < active_threads; thread++) {
+        Worker &worker = workers[thread];
+        if (thread == 0) {
+            worker.network = &network;
+            worker.gogame = &i_gogame;
+        } else {
+            helper_networks.emplace_back(network);
+            helper_games.emplace_back(new GoGame(i_gogame));
+            worker.network = &helper_networks.back();
+            worker.gogame = helper_games.back().get();
+        }
+
+        worker.aborted = false;
+        worker.abortable = false;
+        worker.pending_nodes = 0;
+        worker.cutoffs = 0;
+        worker.first_move_cutoffs = 0;
+        worker.researches = 0;
+        worker.table_stats = GoTranspositionStats();
+        worker.depth = 0;
+        worker.value = 0;
+        worker.previous_pv.clear();
+        worker.principal_variation.clear();
+        worker.pv_table.assign(std::max(limits.max_depth, 1) + 1, std::vector<GoMove>());
+
+        // Killers are kept for one search. History is kept between searches of the same board size, halved so it
+        // follows the game.
+        std::array<uint16_t, GOSEARCH_KILLER_SLOTS> no_killers;
+        no_killers.fill(GOTT_MOVE_NONE);
+        worker.killers.assign(worker.pv_table.size(), no_killers);
+        for (std::vector<uint32_t> &color_history : worker.history) {
+            if (color_history.size() != size_t(board_size * board_size)) {
+                color_history.assign(board_size * board_size, 0);
+            }
+            for (uint32_t &score : color_history) {
+                score /= 2;
+            }
+        }
+    }
+
+    // One worker per thread. The main thread stops the helpers when it finishes, and helpers not yet started when
+    // it does return at once.
+    #pragma omp parallel for num_threads(active_threads) schedule(static, 1)
+    for (unsigned int thread = 0; thread < active_threads; thread++) {
+        search_thread(workers[thread], thread, color);
+        if (thread == 0) {
+            stop = true;
+        }
+    }
+
+    // Take the deepest completed iteration, preferring the main thread on ties
+    const Worker *best_worker = &workers[0];
+    for (const Worker &worker : workers) {
+        result.cutoffs += worker.cutoffs;
+        result.first_move_cutoffs += worker.first_move_cutoffs;
+        result.researches += worker.researches;
+        result.table_stats += worker.table_stats;
+        if (worker.depth > best_worker->depth) {
+            best_worker = &worker;
+        }
+    }
+    if (best_worker->depth > 0) {
+        result.best_move = best_worker->principal_variation[0];
+        result.value = best_worker->value;
+        result.depth = best_worker->depth;
+        result.principal_variation = best_worker->principal_variation;
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_time;
+    result.nodes = nodes;
+    result.elapsed = elapsed.count();
+    return result;
+}
+
+void GoSearch::set_thread_count(const unsigned int i_thread_count) {
+    thread_count = std::max(i_thread_count, 1u);
+}
+
+unsigned int GoSearch::get_thread_count() const {
+    return thread_count;
+}
+
+void GoSearch::clear() {
+    table.clear();
+    for (Worker &worker : workers) {
+        for (std::vector<uint32_t> &color_history : worker.history) {
+            color_history.clear();
+        }
+    }
+}
+
+const GoTranspositionTable &GoSearch::get_table() const {
+    return table;
+}
@@ -0,0 +1,199 @@
+// Copyright [2016] <duncan@wduncanfraser.com>
+// Prototype for GoSearch, an iterative deepening search driver for the AB search
+
+#ifndef GOGAMEAB_GOSEARCH_H_
+#define GOGAMEAB_GOSEARCH_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <utility>
+#include <cstdint>
+
+#include "gogame.h"
+#include "gogamenn.h"
+#include "gotranspositiontable.h"
+
+// Default deepest iteration
+#define GOSEARCH_DEFAULT_DEPTH 4
+// Killer moves kept per ply
+#define GOSEARCH_KILLER_SLOTS 2
+// History scores are halved when one passes this
+#define GOSEARCH_HISTORY_MAX 65536
+// Leaves evaluated per batch. Smaller batches stop sooner after a cut off, larger ones evaluate faster.
+#define GOSEARCH_LEAF_BATCH 4
+// Half width of the root window around the value of the previous iteration
+#define GOSEARCH_ASPIRATION_WINDOW 0.05
+// Nodes a thread visits between checks of the node and time budgets
+#define GOSEARCH_CHECK_INTERVAL 1024
+
+// Struct for holding the limits of a search. The first iteration always completes, so a move is always returned.
+struct GoSearchLimits {
+    // Deepest iteration to search
+    int max_depth;
+    // Node budget. 0 for no limit. Budgets are checked every GOSEARCH_CHECK_INTERVAL nodes of each thread, so a
+    // search may pass them by that many nodes per thread.
+    uint64_t max_nodes;
+    // Time budget in seconds. 0 for no limit.
+    double max_time;
+
+    explicit GoSearchLimits(const int i_max_depth = GOSEARCH_DEFAULT_DEPTH, const uint64_t i_max_nodes = 0,
+                            const double i_max_time = 0) :
+            max_depth(i_max_depth), max_nodes(i_max_nodes), max_time(i_max_time) { }
+};
+
+// Struct for holding the result of a search, from the deepest completed iteration
+struct GoSearchResult {
+    GoMove best_move;
+    // Value of the best move for the searching color
+    double value;
+    // Depth of the deepest completed iteration
+    int depth;
+    // Expected line of play, starting with the best move. Ends early where the line was answered from the table.
+    std::vector<GoMove> principal_variation;
+    // Positions visited, over all iterations
+    uint64_t nodes;
+    // Time taken in seconds
+    double elapsed;
+    // Nodes cut off, and those cut off by their first move, over all iterations
+    uint64_t cutoffs;
+    uint64_t first_move_cutoffs;
+    // Moves searched again with a full window after failing high on a null window, and root searches repeated
+    // after falling outside the aspiration window
+    uint64_t researches;
+    // Transposition table use of all threads
+    GoTranspositionStats table_stats;
+
+    explicit GoSearchResult(const GoBoard &i_goboard) : best_move(i_goboard), value(0), depth(0), nodes(0),
+                                                        elapsed(0), cutoffs(0), first_move_cutoffs(0),
+                                                        researches(0) { }
+
+    // Function to get the fraction of cut offs made by the first move searched, a measure of move ordering
+    inline double get_first_move_rate() const {
+        return (cutoffs == 0) ? 0 : double(first_move_cutoffs) / cutoffs;
+    }
+};
+
+// Iterative deepening search driver. Searches one ply deeper each iteration until a limit is reached.
+// Nodes are searched with negamax principal variation search: values are for the side to move, the first move is
+// searched with the full window, and later moves with a null window, searched again only if they fail high. Each
+// iteration searches the root with a window around the previous value, widened if the value falls outside.
+// Moves are ordered by the principal variation of the previous iteration, the best move stored in the transposition
+// table, the killer moves of the ply, which caused recent cut offs among siblings, then the history score of the
+// point, which grows with the depth of cut offs it caused anywhere in the search.
+// With more than one thread, the search is Lazy SMP: every thread searches the whole tree on its own copy of the game
+// and network, sharing only the transposition table. Helper threads start at alternate depths and order the root
+// moves differently, so they fill the table ahead of the main thread. The result is the deepest completed iteration
+// of any thread, preferring the main thread. A search started inside an OpenMP parallel region runs on one thread.
+// The table is kept between searches, and must be cleared with clear if the network changes.
+class GoSearch {
+ private:
+    // State of one search thread
+    struct Worker {
+        // Network and game searched. The main thread searches the caller's network and game in place.
+        GoGameNN *network;
+        GoGame *gogame;
+
+        // Set when a limit is reached during an iteration that may be abandoned
+        bool aborted;
+        bool abortable;
+        // Nodes visited since the last check of the limits, not yet added to the shared count
+        uint64_t pending_nodes;
+
+        // Principal variation of the last completed iteration
+        std::vector<GoMove> previous_pv;
+        // Principal variations found at each ply of the current iteration
+        std::vector<std::vector<GoMove>> pv_table;
+
+        // Killer move codes by ply, most recent first
+        std::vector<std::array<uint16_t, GOSEARCH_KILLER_SLOTS>> killers;
+        // History scores by color and point index
+        std::array<std::vector<uint32_t>, 2> history;
+        // Ordering scores of the list being sorted
+        std::vector<std::pair<uint64_t, size_t>> order_scores;
+
+        uint64_t cutoffs;
+        uint64_t first_move_cutoffs;
+        uint64_t researches;
+        // Transposition table use, kept per thread so counting does not contend
+        GoTranspositionStats table_stats;
+
+        // Last completed iteration
+        int depth;
+        double value;
+        std::vector<GoMove> principal_variation;
+    };
+
+    GoGameNN &network;
+    GoTranspositionTable table;
+    unsigned int thread_count;
+
+    std::vector<Worker> workers;
+    // Network copies of the helper threads. Copies share the weights of network.
+    std::vector<GoGameNN> helper_networks;
+
+    GoSearchLimits limits;
+    std::chrono::steady_clock::time_point start_time;
+    // Nodes visited by all threads, added in batches of GOSEARCH_CHECK_INTERVAL by each thread
+    std::atomic<uint64_t> nodes;
+    // Set when the main thread finishes, to stop the helpers
+    std::atomic<bool> stop;
+
+    // Function to check the node and time budgets, and the stop flag. Adds the pending nodes of worker to the shared
+    // count first. Sets aborted if a limit is reached and the iteration may be abandoned.
+    bool check_limits(Worker &worker);
+
+    // Function to count nodes visited by worker. Checks the stop flag, and the budgets with check_limits once
+    // GOSEARCH_CHECK_INTERVAL nodes are pending. Returns true if a limit is reached.
+    bool count_nodes(Worker &worker, const uint64_t count);
+
+    // Function to move the move with code to the front of move_list, keeping the order of the rest
+    static void move_to_front(std::vector<GoMove> &move_list, const uint16_t code, const uint8_t board_size);
+
+    // Function to sort move_list for move_color at ply. Moves with equal scores keep their order.
+    static void order_moves(Worker &worker, std::vector<GoMove> &move_list, const size_t ply, const bool move_color,
+                            const uint16_t pv_move, const uint16_t hash_move, const uint8_t board_size);
+
+    // Function to record a cut off by the move with code, for move_color at ply, with depth left
+    static void record_cutoff(Worker &worker, const uint16_t code, const size_t ply, const bool move_color,
+                              const int depth);
+
+    // Function to search move of move_color at ply, with depth left before the move. Returns the value for
+    // move_color. Moves after the first are searched with a null window first.
+    double search_child(Worker &worker, const GoMove &move, const int depth, const size_t ply, const double alpha,
+                        const double beta, const bool move_color, const bool player_color, const bool first,
+                        const bool on_pv);
+
+    // Function to search the game of worker to depth. Returns the value for move_color, found with the evaluation
+    // of player_color, bounded as for scalable_go_ab_prune: exact inside the window, and only a bound outside it.
+    // on_pv is set while following the principal variation of the previous iteration.
+    double search_node(Worker &worker, const int depth, const size_t ply, double alpha, const double beta,
+                       const bool move_color, const bool player_color, const bool on_pv);
+
+    // Function to run iterative deepening on one thread. Thread 0 is the main thread.
+    void search_thread(Worker &worker, const unsigned int thread, const bool color);
+
+ public:
+    // Constructor with the network to search with, the transposition table size in MB, and the thread count
+    explicit GoSearch(GoGameNN &i_network, const size_t table_size_mb = GOTT_DEFAULT_SIZE_MB,
+                      const unsigned int i_thread_count = 1);
+
+    // Function to search for the best move of color on i_gogame. i_gogame is returned to its original state.
+    // Inside a parallel region the search runs on one thread, whatever the thread count.
+    GoSearchResult search(GoGame &i_gogame, const bool color, const GoSearchLimits &i_limits = GoSearchLimits());
+
+    // Function to set the number of search threads. 0 is treated as 1. Searches inside a parallel region use 1.
+    void set_thread_count(const unsigned int i_thread_count);
+
+    // Function to get the number of search threads
+    unsigned int get_thread_count() const;
+
+    // Function to clear the transposition table and history scores, for when the network changes
+    void clear();
+
+    // Function to get the transposition table
+    const GoTranspositionTable &get_table() const;
+};
+
+#endif  // GOGAMEAB_GOSEARCH_H_
@@ -0,0 +1,174 @@
+// Copyright [2016] <duncan@wduncanfraser.com>
+// Implementation of GoTranspositionTable
+
+#include <cstring>
+#include <new>
+
+#include "gotranspositiontable.h"
+
+// Function to mix the bits of x, so nearby inputs give unrelated keys. splitmix64 finalizer.
+static inline uint64_t mix_key(uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+uint64_t get_search_key(const GoGame &i_gogame, const bool move_color, const bool player_color) {
+    std::array<uint8_t, 2> pieces_placed = i_gogame.get_pieces_placed();
+    std::array<uint8_t, 2> prisoner_count = i_gogame.get_prisoner_count();
+
+    // The marker bit keeps counts nonzero, so the empty board, which hashes to 0, does not get key 0. A zero check
+    // word marks an empty slot, which reads as holding key 0.
+    uint64_t counts = uint64_t(pieces_placed[0]) | (uint64_t(pieces_placed[1]) << 8) |
+                      (uint64_t(prisoner_count[0]) << 16) | (uint64_t(prisoner_count[1]) << 24) |
+                      (uint64_t(move_color) << 32) | (uint64_t(player_color) << 33) | (uint64_t(1) << 34);
+    return i_gogame.get_hash() ^ mix_key(counts);
+}
+
+uint16_t get_move_code(const GoMove &i_move, const uint8_t board_size) {
+    if (i_move.check_pass()) {
+        return GOTT_MOVE_PASS;
+    }
+    XYCoordinate piece = i_move.get_piece();
+    return uint16_t(piece.y * board_size + piece.x);
+}
+
+// Info word layout: best move in bits 0-15, bound in bits 16-23, generation in bits 24-31, depth in bits 32-63
+static inline uint64_t pack_info(const int depth, const GoBound bound, const uint8_t generation,
+                                 const uint16_t best_move) {
+    return uint64_t(best_move) | (uint64_t(bound) << 16) | (uint64_t(generation) << 24) |
+           (uint64_t(uint32_t(depth)) << 32);
+}
+
+static inline int get_info_depth(const uint64_t info) {
+    return int32_t(uint32_t(info >> 32));
+}
+
+static inline uint8_t get_info_generation(const uint64_t info) {
+    return uint8_t(info >> 24);
+}
+
+GoTranspositionTable::GoTranspositionTable(const size_t size_mb) : buckets(nullptr), bucket_mask(0), generation(0) {
+    resize(size_mb);
+}
+
+void GoTranspositionTable::resize(const size_t size_mb) {
+    if (size_mb == 0) {
+        throw GoTranspositionTableSizeError();
+    }
+
+    // Largest power of 2 bucket count that fits
+    size_t bucket_count = 1;
+    while (bucket_count * 2 * sizeof(Bucket) <= size_mb * 1024 * 1024) {
+        bucket_count *= 2;
+    }
+
+    // new does not align past alignof(std::max_align_t) before C++17, so the buckets are aligned within storage
+    storage.reset(new char[bucket_count * sizeof(Bucket) + GOTT_CACHE_LINE]);
+    uintptr_t address = reinterpret_cast<uintptr_t>(storage.get());
+    address = (address + GOTT_CACHE_LINE - 1) & ~uintptr_t(GOTT_CACHE_LINE - 1);
+    buckets = new (reinterpret_cast<void *>(address)) Bucket[bucket_count];
+    bucket_mask = bucket_count - 1;
+    clear();
+}
+
+void GoTranspositionTable::clear() {
+    for (size_t i = 0; i <= bucket_mask; i++) {
+        for (Entry &entry : buckets[i].entries) {
+            // A zero check word reads as key 0 with zero data, which get_search_key never returns for a position
+            entry.check.store(0, std::memory_order_relaxed);
+            entry.value.store(0, std::memory_order_relaxed);
+            entry.info.store(0, std::memory_order_relaxed);
+        }
+    }
+    generation = 0;
+}
+
+void GoTranspositionTable::new_search() {
+    generation++;
+}
+
+inline bool GoTranspositionTable::read_entry(const Entry &entry, const uint64_t key, uint64_t &value,
+                                             uint64_t &info) const {
+    uint64_t check = entry.check.load(std::memory_order_relaxed);
+    value = entry.value.load(std::memory_order_relaxed);
+    info = entry.info.load(std::memory_order_relaxed);
+    return (check ^ value ^ info) == key;
+}
+
+bool GoTranspositionTable::probe(const uint64_t key, GoTranspositionEntry &entry, GoTranspositionStats *stats) {
+    if (stats != nullptr) {
+        stats->probes++;
+    }
+    const Bucket &bucket = buckets[key & bucket_mask];
+
+    for (const Entry &slot : bucket.entries) {
+        uint64_t value, info;
+        if (read_entry(slot, key, value, info)) {
+            if (stats != nullptr) {
+                stats->hits++;
+            }
+            entry.depth = get_info_depth(info);
+            entry.bound = GoBound(uint8_t(info >> 16));
+            std::memcpy(&entry.value, &value, sizeof(double));
+            entry.best_move = uint16_t(info);
+            return true;
+        }
+    }
+    return false;
+}
+
+void GoTranspositionTable::store(const uint64_t key, const int depth, const GoBound bound, const double value,
+                                 const uint16_t best_move, GoTranspositionStats *stats) {
+    if (stats != nullptr) {
+        stats->stores++;
+    }
+    Bucket &bucket = buckets[key & bucket_mask];
+
+    // Pick the slot. A slot already holding key is updated in place, unless it holds a deeper result and the new one
+    // is only a bound. Then an empty slot is filled. Otherwise the deep slot is used if the new result is at least as
+    // deep, or the deep slot is from an earlier search, and the always replace slot if not.
+    Entry *slot = nullptr;
+    uint64_t old_value, old_info;
+    for (Entry &candidate : bucket.entries) {
+        if (read_entry(candidate, key, old_value, old_info)) {
+            if ((bound != GoBound::exact) && (get_info_depth(old_info) > depth)) {
+                return;
+            }
+            slot = &candidate;
+            break;
+        }
+    }
+    if (slot == nullptr) {
+        for (Entry &candidate : bucket.entries) {
+            if (candidate.check.load(std::memory_order_relaxed) == 0) {
+                slot = &candidate;
+                break;
+            }
+        }
+    }
+    if (slot == nullptr) {
+        Entry &deep = bucket.entries[0];
+        uint64_t deep_info = deep.info.load(std::memory_order_relaxed);
+        if ((depth >= get_info_depth(deep_info)) || (get_info_generation(deep_info) != generation)) {
+            slot = &deep;
+        } else {
+            slot = &bucket.entries[1];
+        }
+        if (stats != nullptr) {
+            stats->replacements++;
+        }
+    }
+
+    uint64_t value_bits;
+    std::memcpy(&value_bits, &value, sizeof(double));
+    uint64_t info = pack_info(depth, bound, generation, best_move);
+
+    slot->value.store(value_bits, std::memory_order_relaxed);
+    slot->info.store(info, std::memory_order_relaxed);
+    slot->check.store(key ^ value_bits ^ info, std::memory_order_relaxed);
+}
+
+size_t GoTranspositionTable::get_size() const {
+    return (bucket_mask + 1) * sizeof(Bucket);
+}
@@ -0,0 +1,141 @@
+// Copyright [2016] <duncan@wduncanfraser.com>
+// Prototype for GoTranspositionTable, a fixed size lock free transposition table for the AB search
+
+#ifndef GOGAMEAB_GOTRANSPOSITIONTABLE_H_
+#define GOGAMEAB_GOTRANSPOSITIONTABLE_H_
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+#include "gogame.h"
+
+// Default table size in MB
+#define GOTT_DEFAULT_SIZE_MB 16
+// Move code of a pass, and of no move
+#define GOTT_MOVE_PASS 0xFFFE
+#define GOTT_MOVE_NONE 0xFFFF
+// Cache line size buckets are aligned to
+#define GOTT_CACHE_LINE 64
+
+class GoTranspositionTableSizeError : public std::runtime_error {
+ public:
+    GoTranspositionTableSizeError() : std::runtime_error("GoTranspositionTableSizeError") { }
+};
+
+// Relation of a stored value to the true value of the position
+enum class GoBound : uint8_t {
+    // The true value
+    exact,
+    // The search failed high. The true value is at least the stored value.
+    lower,
+    // The search failed low. The true value is at most the stored value.
+    upper
+};
+
+// Struct for holding the result of a transposition table probe
+struct GoTranspositionEntry {
+    // Remaining search depth the value was calculated with. Leaf evaluations are depth 0.
+    int depth;
+    GoBound bound;
+    double value;
+    // Code of the best move found, as given by get_move_code. GOTT_MOVE_NONE if there is none.
+    uint16_t best_move;
+};
+
+// Struct for holding probe and store counters, for sizing the table. Counters are kept by the caller, one set per
+// thread, so counting does not share a cache line between threads.
+struct GoTranspositionStats {
+    uint64_t probes;
+    // Probes that found their position
+    uint64_t hits;
+    uint64_t stores;
+    // Stores that overwrote a different position
+    uint64_t replacements;
+
+    GoTranspositionStats() : probes(0), hits(0), stores(0), replacements(0) { }
+
+    // Function to add the counters of another thread
+    inline GoTranspositionStats &operator+=(const GoTranspositionStats &i_stats) {
+        probes += i_stats.probes;
+        hits += i_stats.hits;
+        stores += i_stats.stores;
+        replacements += i_stats.replacements;
+        return *this;
+    }
+
+    // Function to get the fraction of probes that hit
+    inline double get_hit_rate() const {
+        return (probes == 0) ? 0 : double(hits) / probes;
+    }
+};
+
+// Function to get the transposition key of the current position of i_gogame. Combines the board hash with the side
+// to move, the perspective being searched for, and the piece and prisoner counts, which the network sees. Never 0 for
+// the empty board, as 0 marks an empty slot.
+uint64_t get_search_key(const GoGame &i_gogame, const bool move_color, const bool player_color);
+
+// Function to get the code of a move, unique among the moves of one position
+uint16_t get_move_code(const GoMove &i_move, const uint8_t board_size);
+
+// Fixed size transposition table. Safe to probe and store from several threads at once without locks: each entry is
+// stored with its key XORed with its data, so an entry torn by concurrent stores fails the key check on probe and
+// reads as a miss.
+// Buckets hold two entries, in one cache line. The first keeps the deepest result of the current search, the second
+// always takes the latest store. A deeper result for a position is only replaced by an exact one. Values are only
+// valid for one network, so the table must be cleared when the network changes.
+class GoTranspositionTable {
+ private:
+    // Entry with the key XORed with the value and info words
+    struct Entry {
+        std::atomic<uint64_t> check;
+        std::atomic<uint64_t> value;
+        std::atomic<uint64_t> info;
+    };
+
+    // Two entries per bucket, aligned and padded to a cache line, so a probe touches one line
+    struct alignas(GOTT_CACHE_LINE) Bucket {
+        Entry entries[2];
+    };
+    static_assert(sizeof(Bucket) == GOTT_CACHE_LINE, "GoTranspositionTable buckets must fill one cache line");
+
+    // Allocated storage, with room to align the buckets to a cache line
+    std::unique_ptr<char[]> storage;
+    // Aligned start of the buckets within storage
+    Bucket *buckets;
+    // Number of buckets, a power of 2, less 1
+    size_t bucket_mask;
+    // Search generation, stored with entries so the deep slot is replaced by newer searches
+    uint8_t generation;
+
+    // Function to read an entry. Returns false if the entry does not hold key.
+    inline bool read_entry(const Entry &entry, const uint64_t key, uint64_t &value, uint64_t &info) const;
+
+ public:
+    // Constructor with the table size in MB. The bucket count is rounded down to a power of 2.
+    // Throws GoTranspositionTableSizeError if the size is 0.
+    explicit GoTranspositionTable(const size_t size_mb = GOTT_DEFAULT_SIZE_MB);
+
+    // Function to change the size of the table. Clears the table.
+    void resize(const size_t size_mb);
+
+    // Function to remove all entries. Not safe while other threads use the table.
+    void clear();
+
+    // Function to start a new search. Entries of earlier searches become preferred for replacement.
+    void new_search();
+
+    // Function to look up key. Returns true and fills entry on a hit. Counts the probe in stats, if not null.
+    bool probe(const uint64_t key, GoTranspositionEntry &entry, GoTranspositionStats *stats = nullptr);
+
+    // Function to store the result of a search of key. Counts the store in stats, if not null.
+    void store(const uint64_t key, const int depth, const GoBound bound, const double value,
+               const uint16_t best_move, GoTranspositionStats *stats = nullptr);
+
+    // Function to get the table size in bytes
+    size_t get_size() const;
+};
+
+#endif  // GOGAMEAB_GOTRANSPOSITIONTABLE_H_
@@ -3,7 +3,10 @@
 
 #include <algorithm>
 #include <array>
+#include <string>
 #include <vector>
+#include <memory>
+#include <fstream>
 #include <cstdint>
 #include <limits>
 #include <cmath>
@@ -38,7 +41,7 @@ std::vector<std::vector<double>> get_go_network_translation(const GoGame &i_goga
     // Get the board segments
     std::vector<uint8_t> board_segments = get_go_board_segments(board_size);
     // Get the board
-    GoBoard goboard = i_gogame.get_board();
+    const GoBoard &goboard = i_gogame.get_board();
 
     // Create vector for holding segments.
     std::vector<std::vector<double>> output;
@@ -89,6 +92,245 @@ std::vector<std::vector<double>> get_go_network_translation(const GoGame &i_goga
     return output;
 }
 
+GoGameNNInput get_go_network_input(const GoGame &i_gogame, const bool color) {
+    return GoGameNNInput {get_go_network_translation(i_gogame, color), i_gogame.get_pieces_placed()[color],
+                          i_gogame.get_prisoner_count()[color], i_gogame.get_prisoner_count()[!color]};
+}
+
+// Function to get the padded NeuralNet input layer length of a segment size, including the bias neuron
+static inline size_t get_segment_stride(const uint8_t segment) {
+    return (size_t(segment) * segment + 1 + NEURALNET_SIMD_WIDTH - 1) / NEURALNET_SIMD_WIDTH * NEURALNET_SIMD_WIDTH;
+}
+
+// Function to build the layout for a board size
+static GoGameNNLayout make_go_network_layout(const uint8_t board_size) {
+    GoGameNNLayout layout;
+    layout.board_size = board_size;
+    layout.segments = get_go_board_segments(board_size);
+    layout.length = 0;
+
+    uint16_t window = 0;
+    for (uint8_t segment : layout.segments) {
+        uint16_t segment_count = (board_size - segment + uint16_t(1)) * (board_size - segment + uint16_t(1));
+        layout.segment_counts.push_back(segment_count);
+        layout.first_windows.push_back(window);
+        layout.strides.push_back(get_segment_stride(segment));
+
+        for (uint16_t k = 0; k < segment_count; k++) {
+            layout.window_offsets.push_back(layout.length);
+            layout.length += layout.strides.back();
+        }
+        window += segment_count;
+    }
+    return layout;
+}
+
+const GoGameNNLayout &get_go_network_layout(const uint8_t board_size) {
+    // Layouts of every valid board size, indexed by (board_size - SEGMENT_MIN) / SEGMENT_DIVISION
+    static const std::vector<GoGameNNLayout> layouts = []() {
+        std::vector<GoGameNNLayout> result;
+        for (uint8_t size = SEGMENT_MIN; size <= SEGMENT_MAX; size += SEGMENT_DIVISION) {
+            result.push_back(make_go_network_layout(size));
+        }
+        return result;
+    }();
+
+    if ((board_size < SEGMENT_MIN) || (board_size > SEGMENT_MAX) || ((board_size - SEGMENT_MIN) % SEGMENT_DIVISION)) {
+        throw GoGameNNSegmentError();
+    }
+    return layouts[(board_size - SEGMENT_MIN) / SEGMENT_DIVISION];
+}
+
+// Doubles past the end of the padded board encoding, so window rows can be copied in whole vectors
+#define TRANSLATION_ROW_PADDING 4
+
+// Function to write the windows of one segment size, from the padded board encoding values.
+// Slides across each strip of Segment board rows, so every window row is one fixed length copy of a board row. Rows
+// are copied rounded up to TRANSLATION_ROW_PADDING doubles. The excess lands in the next row, or the bias and padding
+// of the last row, which are written afterwards.
+template <uint8_t Segment, typename Function>
+static void write_segment_windows(const double *values, const uint8_t board_size, uint16_t window,
+                                  Function window_output) {
+    const size_t stride = get_segment_stride(Segment);
+    const size_t copy_length = (Segment + TRANSLATION_ROW_PADDING - 1) / TRANSLATION_ROW_PADDING *
+                               TRANSLATION_ROW_PADDING;
+
+    for (uint8_t y_start = 0; y_start <= board_size - Segment; y_start++) {
+        const double *strip = values + y_start * board_size;
+        for (uint8_t x_start = 0; x_start <= board_size - Segment; x_start++) {
+            double *output = window_output(window++);
+            for (uint8_t y = 0; y < Segment; y++) {
+                const double *row = strip + y * board_size + x_start;
+                for (size_t x = 0; x < copy_length; x++) {
+                    output[y * Segment + x] = row[x];
+                }
+            }
+            // Bias, then padding
+            output[Segment * Segment] = 1.0;
+            for (size_t i = Segment * Segment + 1; i < stride; i++) {
+                output[i] = 0.0;
+            }
+        }
+    }
+}
+
+// Function to write the translation of every window of i_gogame. window_output(window) returns where to write each
+// window's padded input layer.
+// The value of each point is calculated once, into a padded board encoding, so the per point work is O(N^2). Every
+// window is still copied out of it, so the translation as a whole is O(N^4) in the board size. It is not reduced to
+// O(N^2) per segment size: each window has its own layer 1 weights, so no partial sums are shared between windows,
+// and the layer 1 kernels need contiguous, aligned inputs rather than strided board rows. Layer 1 then does a
+// multiply-add per hidden neuron for every translated value, so the copy is at most a few percent of an evaluation
+// (see benchmark_translation).
+template <typename Function>
+static void write_go_network_translation(const GoGame &i_gogame, const bool color, const GoGameNNLayout &layout,
+                                         Function window_output) {
+    const GoBitBoard &board = i_gogame.get_board().board;
+    uint8_t board_size = layout.board_size;
+
+    // Value of each point. Friendly pieces are 1, enemy pieces -1.
+    double values[GOBOARD_MAX_SIZE * GOBOARD_MAX_SIZE + TRANSLATION_ROW_PADDING] = {};
+    board.get_stones(color).for_each([&values](const uint16_t index) {
+        values[index] = 1;
+    });
+    board.get_stones(!color).for_each([&values](const uint16_t index) {
+        values[index] = -1;
+    });
+
+    for (size_t j = 0; j < layout.segments.size(); j++) {
+        uint16_t window = layout.first_windows[j];
+        switch (layout.segments[j]) {
+            case 3: write_segment_windows<3>(values, board_size, window, window_output); break;
+            case 5: write_segment_windows<5>(values, board_size, window, window_output); break;
+            case 7: write_segment_windows<7>(values, board_size, window, window_output); break;
+            case 9: write_segment_windows<9>(values, board_size, window, window_output); break;
+            case 11: write_segment_windows<11>(values, board_size, window, window_output); break;
+            case 13: write_segment_windows<13>(values, board_size, window, window_output); break;
+            case 15: write_segment_windows<15>(values, board_size, window, window_output); break;
+            case 17: write_segment_windows<17>(values, board_size, window, window_output); break;
+            case 19: write_segment_windows<19>(values, board_size, window, window_output); break;
+            default: throw GoGameNNSegmentError();
+        }
+    }
+}
+
+void get_go_network_translation(const GoGame &i_gogame, const bool color, double *output) {
+    const GoGameNNLayout &layout = get_go_network_layout(i_gogame.get_size());
+    write_go_network_translation(i_gogame, color, layout, [&layout, output](const uint16_t window) {
+        return output + layout.window_offsets[window];
+    });
+}
+
+GoGameNNBatch::GoGameNNBatch() : layout(nullptr), capacity(0) { }
+
+GoGameNNBatch::GoGameNNBatch(const uint8_t i_board_size) : layout(&get_go_network_layout(i_board_size)),
+                                                           capacity(0) { }
+
+void GoGameNNBatch::clear() {
+    counts.clear();
+}
+
+void GoGameNNBatch::clear(const uint8_t i_board_size) {
+    const GoGameNNLayout *new_layout = &get_go_network_layout(i_board_size);
+    if (new_layout != layout) {
+        // Storage is laid out for the old board size
+        layout = new_layout;
+        translations = NeuralNetBuffer<double>();
+        block_offsets.clear();
+        capacity = 0;
+    }
+    counts.clear();
+}
+
+void GoGameNNBatch::reserve(const size_t i_capacity) {
+    if (i_capacity <= capacity) {
+        return;
+    }
+    size_t new_capacity = std::max(i_capacity, capacity * 2);
+
+    // Lay out one block per segment size, with room for new_capacity positions, and move existing positions across
+    std::vector<size_t> new_block_offsets;
+    size_t offset = 0;
+    for (size_t j = 0; j < layout->segments.size(); j++) {
+        new_block_offsets.push_back(offset);
+        offset += new_capacity * layout->segment_counts[j] * layout->strides[j];
+    }
+
+    NeuralNetBuffer<double> new_translations(offset);
+    for (size_t j = 0; j < block_offsets.size(); j++) {
+        const double *block = translations.get() + block_offsets[j];
+        std::copy(block, block + counts.size() * layout->segment_counts[j] * layout->strides[j],
+                  new_translations.get() + new_block_offsets[j]);
+    }
+
+    translations = new_translations;
+    block_offsets = new_block_offsets;
+    capacity = new_capacity;
+}
+
+double *GoGameNNBatch::get_window(const size_t position, const uint16_t window) {
+    // Segment size of the window
+    size_t j = layout->segments.size() - 1;
+    while (layout->first_windows[j] > window) {
+        j--;
+    }
+    size_t index = position * layout->segment_counts[j] + (window - layout->first_windows[j]);
+    return translations.get() + block_offsets[j] + index * layout->strides[j];
+}
+
+void GoGameNNBatch::add_position(const GoGame &i_gogame, const bool color) {
+    if ((layout == nullptr) || (i_gogame.get_size() != layout->board_size)) {
+        throw GoGameNNFeedForwardError();
+    }
+    reserve(counts.size() + 1);
+
+    size_t position = counts.size();
+    write_go_network_translation(i_gogame, color, *layout, [this, position](const uint16_t window) {
+        return get_window(position, window);
+    });
+    counts.push_back(GoGameNNCounts {i_gogame.get_pieces_placed()[color], i_gogame.get_prisoner_count()[color],
+                                     i_gogame.get_prisoner_count()[!color]});
+}
+
+void GoGameNNBatch::add_input(const GoGameNNInput &input) {
+    if ((layout == nullptr) || (input.segments.size() != layout->window_offsets.size())) {
+        throw GoGameNNFeedForwardError();
+    }
+    reserve(counts.size() + 1);
+
+    size_t position = counts.size();
+    for (size_t j = 0; j < layout->segments.size(); j++) {
+        size_t segment_length = size_t(layout->segments[j]) * layout->segments[j];
+        for (uint16_t window = layout->first_windows[j];
+             window < layout->first_windows[j] + layout->segment_counts[j]; window++) {
+            if (input.segments[window].size() != segment_length) {
+                throw GoGameNNFeedForwardError();
+            }
+            double *output = get_window(position, window);
+            std::copy(input.segments[window].begin(), input.segments[window].end(), output);
+            output[segment_length] = 1.0;
+            std::fill(output + segment_length + 1, output + layout->strides[j], 0.0);
+        }
+    }
+    counts.push_back(GoGameNNCounts {input.pieces_played, input.prisoner_count, input.opponent_prisoner_count});
+}
+
+size_t GoGameNNBatch::size() const {
+    return counts.size();
+}
+
+uint8_t GoGameNNBatch::get_board_size() const {
+    return (layout == nullptr) ? 0 : layout->board_size;
+}
+
+const double *GoGameNNBatch::get_segment_block(const size_t segment_index) const {
+    return translations.get() + block_offsets[segment_index];
+}
+
+const GoGameNNCounts &GoGameNNBatch::get_counts(const size_t position) const {
+    return counts[position];
+}
+
 GoGameNN::GoGameNN(const uint8_t i_board_size, const bool i_uniform) {
     // Check that board dimensions are between 3 and 19, otherwise throw
     if ((i_board_size < 3) || (i_board_size > 19)) {
@@ -117,11 +359,13 @@ GoGameNN::GoGameNN(const uint8_t i_board_size, const bool i_uniform) {
 
         if (uniform) {
             // If uniform, we only need 1 network for each segment size.
+            window_networks.insert(window_networks.end(), segment_count, uint16_t(layer1.size()));
             layer1.push_back(NeuralNet(4, neuron_counts));
         } else {
             // If not uniform, we need a network for each subsection
             // Creating a network for each segment.
             for (uint16_t i = 0; i < segment_count; i++) {
+                window_networks.push_back(uint16_t(layer1.size()));
                 layer1.push_back(NeuralNet(4, neuron_counts));
             }
         }
@@ -137,7 +381,8 @@ GoGameNN::GoGameNN(const uint8_t i_board_size, const bool i_uniform) {
 }
 
 GoGameNN::GoGameNN(const GoGameNN &i_network) : uniform(i_network.uniform), board_size(i_network.board_size),
-                                                layer1(i_network.layer1), layer2(i_network.layer2) { }
+                                                layer1(i_network.layer1), layer2(i_network.layer2),
+                                                window_networks(i_network.window_networks) { }
 
 bool GoGameNN::operator==(const GoGameNN &i_network) const {
     return (layer1 == i_network.layer1) && (layer2 == i_network.layer2) && (board_size == i_network.board_size) &&
@@ -164,61 +409,197 @@ void GoGameNN::mutate(const double &radius) {
     layer2.mutate(radius);
 }
 
+void GoGameNN::set_precision(const NeuralNetPrecision i_precision) {
+    for (NeuralNet &element : layer1) {
+        element.set_precision(i_precision);
+    }
+    layer2.set_precision(i_precision);
+}
+
 void GoGameNN::feed_forward(const std::vector<std::vector<double>> &input_segments, const uint8_t pieces_played,
                                     const uint8_t prisoner_count, const uint8_t opponent_prisoner_count) {
-    // Vector to hold layer2 inputs.
-    std::vector<double> layer2_inputs(input_segments.size(), 0);
+    const GoGameNNLayout &layout = get_go_network_layout(board_size);
 
-    if (uniform) {
-        // Validate size of input_segments
-        std::vector<uint8_t> segments = get_go_board_segments(board_size);
-        std::vector<uint16_t> segment_counts;
-        uint16_t segment_count = 0;
-
-        for (uint8_t &segment : segments) {
-            segment_counts.push_back((board_size - segment + uint16_t(1)) * (board_size - segment + uint16_t(1)));
-            segment_count += segment_counts[segment_counts.size() - 1];
-        }
+    // Validate size of input_segments to layer 1 neural networks
+    if (input_segments.size() != layout.window_offsets.size()) {
+        throw GoGameNNFeedForwardError();
+    }
 
-        if (input_segments.size() != segment_count) {
-            throw GoGameNNFeedForwardError();
+    // Copy the segments into the flat translation
+    if (translation_scratch.size() != layout.length) {
+        translation_scratch = NeuralNetBuffer<double>(layout.length);
+    }
+    for (size_t j = 0; j < layout.segments.size(); j++) {
+        size_t segment_length = size_t(layout.segments[j]) * layout.segments[j];
+        for (uint16_t window = layout.first_windows[j]; window < layout.first_windows[j] + layout.segment_counts[j];
+             window++) {
+            if (input_segments[window].size() != segment_length) {
+                throw GoGameNNFeedForwardError();
+            }
+            double *output = translation_scratch.get() + layout.window_offsets[window];
+            std::copy(input_segments[window].begin(), input_segments[window].end(), output);
+            output[segment_length] = 1.0;
         }
+    }
+
+    feed_forward(translation_scratch.get(), pieces_played, prisoner_count, opponent_prisoner_count);
+}
+
+void GoGameNN::feed_forward(const double *translation, const uint8_t pieces_played, const uint8_t prisoner_count,
+                            const uint8_t opponent_prisoner_count) {
+    const GoGameNNLayout &layout = get_go_network_layout(board_size);
+    layer2_scratch.resize(layout.window_offsets.size() + 3);
 
-        unsigned int i = 0;
-        for (uint16_t j = 0; j < segment_counts.size(); j++) {
-            for (uint16_t k = 0; k < segment_counts[j]; k++) {
-                layer1[j].feed_forward(input_segments[i]);
-                // Once complete. Assign output to layer 2 input.
-                layer2_inputs[i] = layer1[j].get_output()[0];
-                i += 1;
+    if (uniform) {
+        // Each segment size shares one network, and its windows are contiguous, so they are fed forward in place as
+        // one batch
+        for (size_t j = 0; j < layout.segments.size(); j++) {
+            uint16_t first_window = layout.first_windows[j];
+            layer1[j].feed_forward_batch_padded(translation + layout.window_offsets[first_window],
+                                                layout.segment_counts[j], layout.strides[j]);
+
+            // Once complete. Assign outputs to layer 2 input.
+            for (uint16_t k = 0; k < layout.segment_counts[j]; k++) {
+                layer2_scratch[first_window + k] = layer1[j].get_batch_output(k)[0];
             }
         }
     } else {
-        // Validate size of input_segments to layer 1 neural networks
-        if (input_segments.size() != layer1.size()) {
-            throw GoGameNNFeedForwardError();
-        }
-
-        // Pass all inputs to appropriate neural networks and feed forward
+        // Pass all windows to appropriate neural networks and feed forward in place
         for (unsigned int i = 0; i < layer1.size(); i++) {
-            layer1[i].feed_forward(input_segments[i]);
+            layer1[i].feed_forward_padded(translation + layout.window_offsets[i]);
             // Once complete. Assign output to layer 2 input.
-            layer2_inputs[i] = layer1[i].get_output()[0];
+            layer2_scratch[i] = layer1[i].get_output_value(0);
         }
     }
     // Layer 1 is processed. Append values for piece and prisoner counts to input.
+    set_count_inputs(&layer2_scratch[layout.window_offsets.size()], pieces_played, prisoner_count,
+                     opponent_prisoner_count);
+
+    // Feed forward Layer 2
+    layer2.feed_forward(layer2_scratch.data());
+}
+
+void GoGameNN::feed_forward(const GoGame &i_gogame, const bool color) {
+    const GoGameNNLayout &layout = get_go_network_layout(board_size);
+    if (translation_scratch.size() != layout.length) {
+        translation_scratch = NeuralNetBuffer<double>(layout.length);
+    }
+
+    get_go_network_translation(i_gogame, color, translation_scratch.get());
+    feed_forward(translation_scratch.get(), i_gogame.get_pieces_placed()[color], i_gogame.get_prisoner_count()[color],
+                 i_gogame.get_prisoner_count()[!color]);
+}
+
+const double GoGameNN::get_output() const {
+    return layer2.get_output_value(0);
+}
+
+double GoGameNN::feed_forward_window(const uint16_t index, const double *input_layer) {
+    NeuralNet &network = layer1[window_networks[index]];
+    network.feed_forward_padded(input_layer);
+    return network.get_output_value(0);
+}
+
+void GoGameNN::feed_forward_layer2(const std::vector<double> &layer1_outputs, const uint8_t pieces_played,
+                                   const uint8_t prisoner_count, const uint8_t opponent_prisoner_count) {
+    if (layer1_outputs.size() != window_networks.size()) {
+        throw GoGameNNFeedForwardError();
+    }
+
+    layer2_scratch.resize(layer1_outputs.size() + 3);
+    std::copy(layer1_outputs.begin(), layer1_outputs.end(), layer2_scratch.begin());
+    set_count_inputs(&layer2_scratch[layer1_outputs.size()], pieces_played, prisoner_count, opponent_prisoner_count);
+    layer2.feed_forward(layer2_scratch.data());
+}
+
+uint16_t GoGameNN::get_window_count() const {
+    return uint16_t(window_networks.size());
+}
+
+void GoGameNN::set_count_inputs(double *count_inputs, const uint8_t pieces_played, const uint8_t prisoner_count,
+                                const uint8_t opponent_prisoner_count) const {
     // Values are normalized to 1/2 the total board pieces rounded down. So for a 3x3 game. 9 pieces. Normalized by 4.
     uint8_t normalization = uint8_t((board_size * board_size) / 2);
-    layer2_inputs.push_back(pieces_played / normalization);
-    layer2_inputs.push_back(prisoner_count / normalization);
-    layer2_inputs.push_back(opponent_prisoner_count / normalization);
+    count_inputs[0] = pieces_played / normalization;
+    count_inputs[1] = prisoner_count / normalization;
+    count_inputs[2] = opponent_prisoner_count / normalization;
+}
+
+void GoGameNN::feed_forward_batch(const std::vector<GoGameNNInput> &inputs) {
+    batch_scratch.clear(board_size);
+    for (const GoGameNNInput &input : inputs) {
+        batch_scratch.add_input(input);
+    }
+    feed_forward_batch(batch_scratch);
+}
+
+void GoGameNN::feed_forward_batch(const GoGameNNBatch &batch) {
+    const GoGameNNLayout &layout = get_go_network_layout(board_size);
+    if (batch.get_board_size() != board_size) {
+        throw GoGameNNFeedForwardError();
+    }
+    if (batch.size() == 0) {
+        batch_output.clear();
+        return;
+    }
+
+    // Padded layer 2 inputs, one row per position. Bias and padding are set when the rows are allocated.
+    size_t window_count = layout.window_offsets.size();
+    size_t layer2_stride = layer2.get_input_stride();
+    if (layer2_batch.size() < batch.size() * layer2_stride) {
+        layer2_batch = NeuralNetBuffer<double>(std::max(batch.size(), 2 * layer2_batch.size() / layer2_stride) *
+                                               layer2_stride);
+        for (size_t b = 0; b < layer2_batch.size() / layer2_stride; b++) {
+            layer2_batch.get()[b * layer2_stride + window_count + 3] = 1.0;
+        }
+    }
+
+    for (size_t j = 0; j < layout.segments.size(); j++) {
+        // Windows of a size are grouped by position in the batch, position b starting position_stride after b - 1
+        const double *block = batch.get_segment_block(j);
+        size_t position_stride = layout.segment_counts[j] * layout.strides[j];
+        uint16_t first_window = layout.first_windows[j];
+
+        if (uniform) {
+            // One network per segment size, batched over every window of that size in every position
+            layer1[j].feed_forward_batch_padded(block, batch.size() * layout.segment_counts[j], layout.strides[j]);
+
+            size_t index = 0;
+            for (size_t b = 0; b < batch.size(); b++) {
+                for (uint16_t k = 0; k < layout.segment_counts[j]; k++) {
+                    layer2_batch.get()[b * layer2_stride + first_window + k] = layer1[j].get_batch_output(index++)[0];
+                }
+            }
+        } else {
+            // One network per window, batched over the same window of every position
+            for (uint16_t k = 0; k < layout.segment_counts[j]; k++) {
+                NeuralNet &network = layer1[first_window + k];
+                network.feed_forward_batch_padded(block + k * layout.strides[j], batch.size(), position_stride);
+
+                for (size_t b = 0; b < batch.size(); b++) {
+                    layer2_batch.get()[b * layer2_stride + first_window + k] = network.get_batch_output(b)[0];
+                }
+            }
+        }
+    }
+
+    for (size_t b = 0; b < batch.size(); b++) {
+        const GoGameNNCounts &counts = batch.get_counts(b);
+        set_count_inputs(layer2_batch.get() + b * layer2_stride + window_count, counts.pieces_played,
+                         counts.prisoner_count, counts.opponent_prisoner_count);
+    }
 
     // Feed forward Layer 2
-    layer2.feed_forward(layer2_inputs);
+    layer2.feed_forward_batch_padded(layer2_batch.get(), batch.size(), layer2_stride);
+
+    batch_output.resize(batch.size());
+    for (size_t b = 0; b < batch.size(); b++) {
+        batch_output[b] = layer2.get_batch_output(b)[0];
+    }
 }
 
-const double GoGameNN::get_output() const {
-    return layer2.get_output()[0];
+const std::vector<double> &GoGameNN::get_batch_output() const {
+    return batch_output;
 }
 
 void GoGameNN::export_weights_stream(std::ofstream &file) {
@@ -239,6 +620,20 @@ void GoGameNN::import_weights_stream(std::ifstream &file) {
     layer2.import_weights_stream(file);
 }
 
+void GoGameNN::export_weights_binary(NeuralNetWeightFileWriter &writer) const {
+    for (const NeuralNet &element : layer1) {
+        element.export_weights_binary(writer);
+    }
+    layer2.export_weights_binary(writer);
+}
+
+void GoGameNN::import_weights_binary(const std::shared_ptr<const NeuralNetWeightFile> &file, size_t &index) {
+    for (NeuralNet &element : layer1) {
+        element.import_weights_binary(file, index);
+    }
+    layer2.import_weights_binary(file, index);
+}
+
 void GoGameNN::scale_network(const GoGameNN &i_network) {
     // First, validate that we are 1 size larger than the passed network.
     if (board_size != (i_network.board_size + SEGMENT_DIVISION)) {
@@ -299,3 +694,28 @@ void GoGameNN::scale_network(const GoGameNN &i_network) {
 std::vector<NeuralNet> GoGameNN::get_layer1() {
     return layer1;
 }
+
+std::string get_go_networks_path(const std::string &base) {
+    if (check_weight_file(base + ".bin")) {
+        return base + ".bin";
+    }
+    return base + ".txt";
+}
+
+void import_go_networks(std::vector<GoGameNN> &networks, const size_t count, const std::string &path) {
+    if (check_weight_file(path)) {
+        std::shared_ptr<const NeuralNetWeightFile> file = std::make_shared<const NeuralNetWeightFile>(path);
+        size_t index = 0;
+        for (size_t i = 0; i < count; i++) {
+            networks[i].import_weights_binary(file, index);
+        }
+    } else {
+        std::ifstream file(path);
+        if (!file.is_open()) {
+            throw NeuralNetImportError();
+        }
+        for (size_t i = 0; i < count; i++) {
+            networks[i].import_weights_stream(file);
+        }
+    }
+}
@@ -4,11 +4,15 @@
 #ifndef GOGAMENN_GOGAMENN_H_
 #define GOGAMENN_GOGAMENN_H_
 
+#include <string>
 #include <vector>
+#include <memory>
+#include <cstddef>
 #include <cstdint>
 #include <stdexcept>
 
 #include "neuralnet.h"
+#include "neuralnetfile.h"
 #include "gogame.h"
 
 #define SEGMENT_MIN 3
@@ -44,6 +48,98 @@ std::vector<uint8_t> get_go_board_segments(const uint8_t board_size);
 // Blank spaces return as 0, friendly pieces return as 1, enemy pieces return as -1
 std::vector<std::vector<double>> get_go_network_translation(const GoGame &i_gogame, const bool color);
 
+// Struct for holding the GoGameNN inputs of one position, for batch evaluation
+struct GoGameNNInput {
+    std::vector<std::vector<double>> segments;
+    uint8_t pieces_played;
+    uint8_t prisoner_count;
+    uint8_t opponent_prisoner_count;
+};
+
+// Function to get the GoGameNN inputs of the current position of i_gogame, from the perspective of color
+GoGameNNInput get_go_network_input(const GoGame &i_gogame, const bool color);
+
+// Struct for holding the layout of a flat GoGameNN translation for one board size.
+// Windows are in get_go_network_translation order. Each is laid out as a padded NeuralNet input layer: the segment
+// values, a bias of 1, then zero padding to a multiple of NEURALNET_SIMD_WIDTH. Windows of one segment size are
+// contiguous, so they can be fed forward in place as one batch.
+struct GoGameNNLayout {
+    uint8_t board_size;
+    // Segment sizes, and the window count, first window and padded window length of each
+    std::vector<uint8_t> segments;
+    std::vector<uint16_t> segment_counts;
+    std::vector<uint16_t> first_windows;
+    std::vector<size_t> strides;
+    // Offset of each window in the translation
+    std::vector<size_t> window_offsets;
+    // Number of doubles in the translation
+    size_t length;
+};
+
+// Function to get the precomputed layout for a board size. Throws GoGameNNSegmentError if not a valid size.
+const GoGameNNLayout &get_go_network_layout(const uint8_t board_size);
+
+// Function to write the translation of the current board state of i_gogame into output, laid out by
+// get_go_network_layout. output must hold the layout length, NEURALNET_ALIGNMENT aligned. Does not allocate.
+void get_go_network_translation(const GoGame &i_gogame, const bool color, double *output);
+
+// Struct for holding the normalized count inputs of one position
+struct GoGameNNCounts {
+    uint8_t pieces_played;
+    uint8_t prisoner_count;
+    uint8_t opponent_prisoner_count;
+};
+
+// Class for holding a batch of positions for GoGameNN::feed_forward_batch, as flat translations.
+// Windows of each segment size are grouped together across positions, so every layer 1 network reads its batch in
+// place. Storage is kept when the batch is cleared, so a reused batch stops allocating once it has grown.
+class GoGameNNBatch {
+ private:
+    const GoGameNNLayout *layout;
+    NeuralNetBuffer<double> translations;
+    // Offset of the windows of each segment size in translations
+    std::vector<size_t> block_offsets;
+    // Number of positions translations has room for
+    size_t capacity;
+    std::vector<GoGameNNCounts> counts;
+
+    // Function to grow storage to hold at least i_capacity positions
+    void reserve(const size_t i_capacity);
+
+    // Function to get the padded input layer of a window of a position
+    double *get_window(const size_t position, const uint16_t window);
+
+ public:
+    // Default Constructor. clear(board_size) must be called before adding positions.
+    GoGameNNBatch();
+
+    // Constructor with board size specification
+    explicit GoGameNNBatch(const uint8_t i_board_size);
+
+    // Function to remove all positions, keeping storage
+    void clear();
+
+    // Function to remove all positions and set the board size. Storage is kept if the board size is unchanged.
+    void clear(const uint8_t i_board_size);
+
+    // Function to add the current position of i_gogame, from the perspective of color
+    void add_position(const GoGame &i_gogame, const bool color);
+
+    // Function to add a position from its inputs. Throws GoGameNNFeedForwardError if the segments do not match.
+    void add_input(const GoGameNNInput &input);
+
+    // Function to get the number of positions
+    size_t size() const;
+
+    // Function to get the board size
+    uint8_t get_board_size() const;
+
+    // Function to get the windows of a segment size. Position b's windows start b * segment count * stride after.
+    const double *get_segment_block(const size_t segment_index) const;
+
+    // Function to get the count inputs of a position
+    const GoGameNNCounts &get_counts(const size_t position) const;
+};
 
 // Class for holding a GoGame neuralnet. Wrapper around NeuralNet
 class GoGameNN {
@@ -60,6 +156,20 @@ class GoGameNN {
     // Second layer neural net
     NeuralNet layer2;
 
+    // Index of the layer 1 network of each window, in get_go_network_translation order
+    std::vector<uint16_t> window_networks;
+
+    // Scratch for evaluation, kept between calls so evaluation does not allocate. Not copied.
+    NeuralNetBuffer<double> translation_scratch;
+    std::vector<double> layer2_scratch;
+    GoGameNNBatch batch_scratch;
+    NeuralNetBuffer<double> layer2_batch;
+    std::vector<double> batch_output;
+
+    // Function to write the normalized piece and prisoner counts to the 3 layer 2 inputs at count_inputs
+    void set_count_inputs(double *count_inputs, const uint8_t pieces_played, const uint8_t prisoner_count,
+                          const uint8_t opponent_prisoner_count) const;
+
  public:
     // Constructor with size specification
     GoGameNN(const uint8_t i_board_size, const bool i_uniform);
@@ -76,19 +186,59 @@ class GoGameNN {
     // Mutator. Randomly mutates using a uniform distribution
     void mutate(const double &radius);
 
+    // Function to set the inference precision of all networks. Wrapper around NeuralNet::set_precision
+    void set_precision(const NeuralNetPrecision i_precision);
+
     // FeedForward Function, calculate output based on inputs.
     void feed_forward(const std::vector<std::vector<double>> &input_segments, const uint8_t pieces_played,
                       const uint8_t prisoner_count, const uint8_t opponent_prisoner_count);
 
+    // FeedForward Function, reading a flat translation laid out by get_go_network_layout in place. Does not allocate
+    // once scratch space has grown.
+    void feed_forward(const double *translation, const uint8_t pieces_played, const uint8_t prisoner_count,
+                      const uint8_t opponent_prisoner_count);
+
+    // FeedForward Function, evaluating the current position of i_gogame from the perspective of color. Does not
+    // allocate once scratch space has grown.
+    void feed_forward(const GoGame &i_gogame, const bool color);
+
     // Get output
     const double get_output() const;
 
+    // Function to feed forward the layer 1 network of one window, and return its output. input_layer is the window's
+    // padded input layer, as laid out by get_go_network_layout.
+    double feed_forward_window(const uint16_t index, const double *input_layer);
+
+    // Function to feed forward layer 2 from the layer 1 output of every window. Result is available from get_output.
+    void feed_forward_layer2(const std::vector<double> &layer1_outputs, const uint8_t pieces_played,
+                             const uint8_t prisoner_count, const uint8_t opponent_prisoner_count);
+
+    // Function to get the number of layer 1 windows
+    uint16_t get_window_count() const;
+
+    // Batch FeedForward Function. Calculates the output of each position, running each sub-network once for the
+    // whole batch.
+    void feed_forward_batch(const std::vector<GoGameNNInput> &inputs);
+
+    // Batch FeedForward Function, reading the translations of batch in place
+    void feed_forward_batch(const GoGameNNBatch &batch);
+
+    // Function to get the outputs of the last feed_forward_batch, in input order
+    const std::vector<double> &get_batch_output() const;
+
     // Export weights to specified ofstream. Wrapper around NeuralNet::expot_weights_stream
     void export_weights_stream(std::ofstream &file);
 
     // Import weights from specified ifstream. Wrapper around NeuralNet::import_weights_stream
     void import_weights_stream(std::ifstream &file);
 
+    // Export weights to a binary weight file. Wrapper around NeuralNet::export_weights_binary
+    void export_weights_binary(NeuralNetWeightFileWriter &writer) const;
+
+    // Borrow weights in place from a binary weight file, starting at network index. Wrapper around
+    // NeuralNet::import_weights_binary
+    void import_weights_binary(const std::shared_ptr<const NeuralNetWeightFile> &file, size_t &index);
+
     // Import weights from an existing network and scale up. New sections are initialized randomly.
     void scale_network(const GoGameNN &i_network);
 
@@ -96,4 +246,12 @@ class GoGameNN {
     std::vector<NeuralNet> get_layer1();
 };
 
+// Function to get the path of the weight file with base path base: base + ".bin" if it is a binary weight file,
+// otherwise base + ".txt"
+std::string get_go_networks_path(const std::string &base);
+
+// Function to import the first count networks from the weight file at path, detecting the binary or text format.
+// Binary weights are borrowed in place. Throws NeuralNetImportError if the file can not be opened or read.
+void import_go_networks(std::vector<GoGameNN> &networks, const size_t count, const std::string &path);
+
 #endif  // GOGAMENN_GOGAMENN_H_
@@ -0,0 +1,124 @@
+// Copyright [2016] <duncan@wduncanfraser.com>
+// Implementation of GoGameNNEvaluator
+
+#include <algorithm>
+#include <array>
+#include <vector>
+#include <cstdint>
+
+#include "gogamennevaluator.h"
+
+GoGameNNEvaluator::GoGameNNEvaluator(GoGameNN &i_network, const GoGame &i_gogame, const bool i_color) :
+        network(i_network), gogame(i_gogame), color(i_color), board_size(i_gogame.get_size()),
+        layout(get_go_network_layout(board_size)), translation(layout.length), stamp(0), frame_count(0) {
+    uint16_t window_count = uint16_t(layout.window_offsets.size());
+    if (window_count != network.get_window_count()) {
+        throw GoGameNNFeedForwardError();
+    }
+
+    window_outputs.resize(window_count);
+    window_stamps.resize(window_count, 0);
+    refresh();
+}
+
+inline double GoGameNNEvaluator::get_point_value(const uint8_t mask) const {
+    if (mask == 0) {
+        return 0;
+    }
+    // Friendly pieces are 1, enemy pieces -1
+    return (get_piece_bool(mask) == color) ? 1 : -1;
+}
+
+void GoGameNNEvaluator::set_point(const uint16_t index, const double value, GoGameNNEvaluatorFrame *frame) {
+    int x = index % board_size;
+    int y = index / board_size;
+
+    for (size_t j = 0; j < layout.segments.size(); j++) {
+        int segment = layout.segments[j];
+        int windows_per_row = board_size - segment + 1;
+
+        // Windows of this size with the point inside them
+        for (int y_start = std::max(0, y - segment + 1); y_start <= std::min(y, board_size - segment); y_start++) {
+            for (int x_start = std::max(0, x - segment + 1); x_start <= std::min(x, board_size - segment);
+                 x_start++) {
+                uint16_t window = uint16_t(layout.first_windows[j] + y_start * windows_per_row + x_start);
+                translation.get()[layout.window_offsets[window] + (y - y_start) * segment + (x - x_start)] = value;
+
+                if ((frame != nullptr) && (window_stamps[window] != stamp)) {
+                    window_stamps[window] = stamp;
+                    frame->outputs.push_back(std::make_pair(window, window_outputs[window]));
+                }
+            }
+        }
+    }
+}
+
+void GoGameNNEvaluator::refresh() {
+    const GoBitBoard &board = gogame.get_board().board;
+    stones = {board.get_stones(0), board.get_stones(1)};
+    get_go_network_translation(gogame, color, translation.get());
+
+    for (uint16_t i = 0; i < window_outputs.size(); i++) {
+        window_outputs[i] = network.feed_forward_window(i, translation.get() + layout.window_offsets[i]);
+    }
+    frame_count = 0;
+}
+
+void GoGameNNEvaluator::update() {
+    const GoBitBoard &board = gogame.get_board().board;
+
+    if (frame_count == frames.size()) {
+        frames.emplace_back();
+    }
+    GoGameNNEvaluatorFrame &frame = frames[frame_count++];
+    frame.stones = stones;
+    frame.outputs.clear();
+
+    // Write changed points to their windows, recording each window touched
+    stamp++;
+    GoBitSet changed = (stones[0] ^ board.get_stones(0)) | (stones[1] ^ board.get_stones(1));
+    changed.for_each([this, &board, &frame](const uint16_t index) {
+        set_point(index, get_point_value(board.get_point(index)), &frame);
+    });
+    stones = {board.get_stones(0), board.get_stones(1)};
+
+    // Recompute the touched windows
+    for (const std::pair<uint16_t, double> &element : frame.outputs) {
+        const double *input_layer = translation.get() + layout.window_offsets[element.first];
+        window_outputs[element.first] = network.feed_forward_window(element.first, input_layer);
+    }
+}
+
+void GoGameNNEvaluator::rollback() {
+    if (frame_count == 0) {
+        throw GoGameNNEvaluatorRollbackError();
+    }
+    const GoGameNNEvaluatorFrame &frame = frames[--frame_count];
+
+    // Restore the translation of changed points
+    GoBitSet changed = (stones[0] ^ frame.stones[0]) | (stones[1] ^ frame.stones[1]);
+    changed.for_each([this, &frame](const uint16_t index) {
+        uint8_t mask = frame.stones[0].test(index) ? BLACK_MASK : (frame.stones[1].test(index) ? WHITE_MASK : 0);
+        set_point(index, get_point_value(mask), nullptr);
+    });
+    stones = frame.stones;
+
+    // Restore the outputs of recomputed windows
+    for (const std::pair<uint16_t, double> &element : frame.outputs) {
+        window_outputs[element.first] = element.second;
+    }
+}
+
+double GoGameNNEvaluator::evaluate() {
+    network.feed_forward_layer2(window_outputs, gogame.get_pieces_placed()[color], gogame.get_prisoner_count()[color],
+                                gogame.get_prisoner_count()[!color]);
+    return network.get_output();
+}
+
+bool GoGameNNEvaluator::get_color() const {
+    return color;
+}
+
+const double *GoGameNNEvaluator::get_translation() const {
+    return translation.get();
+}
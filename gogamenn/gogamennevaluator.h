@@ -0,0 +1,92 @@
+// Copyright [2016] <duncan@wduncanfraser.com>
+// Prototype for GoGameNNEvaluator, an incremental GoGameNN evaluator bound to a GoGame
+
+#ifndef GOGAMENN_GOGAMENNEVALUATOR_H_
+#define GOGAMENN_GOGAMENNEVALUATOR_H_
+
+#include <array>
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <stdexcept>
+
+#include "gogame.h"
+#include "gogamenn.h"
+
+class GoGameNNEvaluatorRollbackError : public std::runtime_error {
+ public:
+    GoGameNNEvaluatorRollbackError() : std::runtime_error("GoGameNNEvaluatorRollbackError") { }
+};
+
+// Struct for holding the state replaced by one GoGameNNEvaluator::update
+struct GoGameNNEvaluatorFrame {
+    // Stones before the update. black = 0, white = 1
+    std::array<GoBitSet, 2> stones;
+    // Window index and layer 1 output before the update, of every recomputed window
+    std::vector<std::pair<uint16_t, double>> outputs;
+};
+
+// Incremental GoGameNN evaluator, bound to a GoGame and a player color.
+// Keeps the translation and layer 1 output of every window. update() only recomputes windows covering points that
+// changed since the last update, including captures, so a leaf costs a few layer 1 networks plus layer 2.
+// The network and game must outlive the evaluator.
+class GoGameNNEvaluator {
+ private:
+    GoGameNN &network;
+    const GoGame &gogame;
+
+    // Perspective of the translation. Friendly pieces are 1, enemy pieces -1.
+    bool color;
+    uint8_t board_size;
+
+    // Layout of the translation
+    const GoGameNNLayout &layout;
+
+    // Stones the windows were last computed from
+    std::array<GoBitSet, 2> stones;
+
+    // Flat translation, and layer 1 output of each window
+    NeuralNetBuffer<double> translation;
+    std::vector<double> window_outputs;
+
+    // Update of the last recomputation of each window, to recompute a window once per update
+    std::vector<uint32_t> window_stamps;
+    uint32_t stamp;
+
+    // Rollback stack. Frames above frame_count are kept to reuse their storage.
+    std::vector<GoGameNNEvaluatorFrame> frames;
+    size_t frame_count;
+
+    // Function to get the translation value of a point mask
+    inline double get_point_value(const uint8_t mask) const;
+
+    // Function to write the translation value of point index to every window covering it. If frame is not null,
+    // windows not yet touched this update are stamped and their outputs recorded in frame.
+    void set_point(const uint16_t index, const double value, GoGameNNEvaluatorFrame *frame);
+
+ public:
+    // Constructor binding network and game. Windows are built from the current position.
+    GoGameNNEvaluator(GoGameNN &i_network, const GoGame &i_gogame, const bool i_color);
+
+    // Function to rebuild every window from the bound game. Clears the rollback stack.
+    void refresh();
+
+    // Function to bring the windows up to date with the bound game, pushing a rollback frame
+    void update();
+
+    // Function to return the windows to their state before the last update.
+    // Throws GoGameNNEvaluatorRollbackError if there is no update to roll back.
+    void rollback();
+
+    // Function to evaluate the current windows with layer 2, and return the network output
+    double evaluate();
+
+    // Function to get the perspective color
+    bool get_color() const;
+
+    // Function to get the flat translation, laid out by get_go_network_layout. Matches get_go_network_translation
+    // after update.
+    const double *get_translation() const;
+};
+
+#endif  // GOGAMENN_GOGAMENNEVALUATOR_H_
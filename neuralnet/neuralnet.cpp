@@ -7,14 +7,27 @@
 #include <sstream>
 #include <vector>
 #include <random>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
 
 #include "neuralnet.h"
+#include "neuralnetkernels.h"
+#include "neuralnetfile.h"
 
-NeuralNet::NeuralNet() {
+// Function to round a neuron count up to a multiple of NEURALNET_SIMD_WIDTH
+static inline size_t get_padded_length(const size_t length) {
+    return (length + NEURALNET_SIMD_WIDTH - 1) / NEURALNET_SIMD_WIDTH * NEURALNET_SIMD_WIDTH;
+}
+
+NeuralNet::NeuralNet() : layer_count(0), weight_count(0), weights(nullptr),
+                         precision(NeuralNetPrecision::fp64), batch_capacity(0), batch_size(0) {
 
 }
 
-NeuralNet::NeuralNet(const unsigned int i_layer_count, const std::vector<unsigned int> i_neuron_counts) {
+NeuralNet::NeuralNet(const unsigned int i_layer_count, const std::vector<unsigned int> i_neuron_counts) :
+        layer_count(0), weight_count(0), weights(nullptr), precision(NeuralNetPrecision::fp64),
+        batch_capacity(0), batch_size(0) {
     // Check that layer count is correct
     if (i_layer_count == i_neuron_counts.size()) {
         layer_count = i_layer_count;
@@ -23,46 +36,75 @@ NeuralNet::NeuralNet(const unsigned int i_layer_count, const std::vector<unsigne
         // Error generation
         std::cout << "Layer Count does not match input neuron counts.\n";
     }
-    // Resize Neuron and Weight vectors to match layer_count
-    neurons.resize(layer_count);
-    weights.resize(layer_count - 1);
 
-    // Assign/Resize Neuron Vectors to size of neural network layers and initialize to 0.
-    // Input and hidden layers +1 to account for bias
+    // Determine padded layer lengths. Input and hidden layers +1 to account for bias
+    strides.resize(layer_count);
     for (unsigned int i = 0; i < layer_count; i++) {
-        // If output layer, don't add bias
         if (i == (layer_count - 1)) {
-            neurons[i].assign(neuron_counts[i], 0);
+            strides[i] = get_padded_length(neuron_counts[i]);
         } else {
-            // For all other layers, add bias
-            neurons[i].assign(neuron_counts[i] + 1, 0);
-            // Set the bias to 1
-            neurons[i][neuron_counts[i]] = 1.0;
+            strides[i] = get_padded_length(neuron_counts[i] + 1);
         }
     }
 
-    // Assign/Resize Weight Vectors to appropriate size [x][y] and initialize elements to 0.
-    // +1 is to account for bias
+    // Lay out weight matrices and neuron layers. All lengths are multiples of NEURALNET_SIMD_WIDTH, so every matrix
+    // row and neuron layer is aligned.
+    size_t offset = 0;
     for (unsigned int i = 1; i < layer_count; i++) {
-        weights[i - 1].resize(neuron_counts[i]);
+        weight_offsets.push_back(offset);
+        offset += neuron_counts[i] * strides[i - 1];
+    }
+    weight_count = offset;
+    offset = 0;
+    for (unsigned int i = 0; i < layer_count; i++) {
+        neuron_offsets.push_back(offset);
+        offset += strides[i];
+    }
 
-        for (std::vector<double> &row : weights[i - 1]) {
-            row.assign(neuron_counts[i - 1] + 1, 0);
-        }
+    // Allocate the buffers, initialized to 0
+    weight_buffer = std::make_shared<NeuralNetBuffer<double>>(weight_count);
+    weights = weight_buffer->get();
+    neurons = NeuralNetBuffer<double>(offset);
+
+    // Float neurons share the master neuron layout. int8 neurons only hold one layer.
+    neurons_fp32 = NeuralNetBuffer<float>(offset);
+    size_t max_stride = 0;
+    for (unsigned int i = 0; i < layer_count; i++) {
+        max_stride = std::max(max_stride, strides[i]);
+    }
+    neurons_int8 = NeuralNetBuffer<int8_t>(max_stride);
+
+    // One scale per weight row
+    size_t row_offset = 0;
+    for (unsigned int i = 1; i < layer_count; i++) {
+        row_scale_offsets.push_back(row_offset);
+        row_offset += neuron_counts[i];
     }
-}
 
-NeuralNet::NeuralNet(const NeuralNet &i_network) {
-    // Copy layer count
-    layer_count = i_network.layer_count;
-    // Copy layer neuron counts
-    neuron_counts = i_network.neuron_counts;
-    // Copy Neurons
-    neurons = i_network.neurons;
-    // Copy Weights
-    weights = i_network.weights;
+    // Set the bias neurons to 1
+    for (unsigned int i = 0; i < layer_count - 1; i++) {
+        neurons.get()[neuron_offsets[i] + neuron_counts[i]] = 1.0;
+        neurons_fp32.get()[neuron_offsets[i] + neuron_counts[i]] = 1.0f;
+    }
 }
 
+NeuralNet::NeuralNet(const NeuralNet &i_network) : layer_count(i_network.layer_count),
+                                                   neuron_counts(i_network.neuron_counts),
+                                                   strides(i_network.strides),
+                                                   weight_offsets(i_network.weight_offsets),
+                                                   neuron_offsets(i_network.neuron_offsets),
+                                                   weight_count(i_network.weight_count),
+                                                   weight_buffer(i_network.weight_buffer),
+                                                   weights(i_network.weights),
+                                                   weight_file(i_network.weight_file),
+                                                   neurons(i_network.neurons),
+                                                   precision(i_network.precision),
+                                                   inference_weights(i_network.inference_weights),
+                                                   row_scale_offsets(i_network.row_scale_offsets),
+                                                   neurons_fp32(i_network.neurons_fp32),
+                                                   neurons_int8(i_network.neurons_int8),
+                                                   batch_capacity(0), batch_size(0) { }
+
 NeuralNet::~NeuralNet() {
     // std::cout << "Running Destructor";
 }
@@ -73,20 +115,39 @@ NeuralNet &NeuralNet::operator=(const NeuralNet &i_network) {
         layer_count = i_network.layer_count;
         // Copy layer neuron counts
         neuron_counts = i_network.neuron_counts;
-        // Copy Neurons
-        neurons = i_network.neurons;
-        // Copy Weights
+        // Copy layout
+        strides = i_network.strides;
+        weight_offsets = i_network.weight_offsets;
+        neuron_offsets = i_network.neuron_offsets;
+        weight_count = i_network.weight_count;
+        // Share Weights, and copy Neurons
+        weight_buffer = i_network.weight_buffer;
+        weight_file = i_network.weight_file;
         weights = i_network.weights;
+        neurons = i_network.neurons;
+        // Copy inference precision and reduced precision weights
+        precision = i_network.precision;
+        inference_weights = i_network.inference_weights;
+        row_scale_offsets = i_network.row_scale_offsets;
+        neurons_fp32 = i_network.neurons_fp32;
+        neurons_int8 = i_network.neurons_int8;
+        // Batch neurons are scratch space, and depend on the layout. Release them, and grow again on demand.
+        batch_neurons = NeuralNetBuffer<double>();
+        batch_offsets.clear();
+        batch_capacity = 0;
+        batch_size = 0;
     }
     return *this;
 }
 
 bool NeuralNet::operator==(const NeuralNet &i_network) const {
-    return (weights == i_network.weights);
+    // Padding is always 0, so the weight regions can be compared directly
+    return (neuron_counts == i_network.neuron_counts) &&
+           ((weights == i_network.weights) || std::equal(weights, weights + weight_count, i_network.weights));
 }
 
 bool NeuralNet::operator!=(const NeuralNet &i_network) const {
-    return (weights != i_network.weights);
+    return !(*this == i_network);
 }
 
 void NeuralNet::initialize_random() {
@@ -98,13 +159,10 @@ void NeuralNet::initialize_random() {
     std::uniform_real_distribution<double> distribution(-1.0, 1.0);
 
     // Assign random values to each element in each row of weight table
-    for (std::vector<std::vector<double>> &layer : weights) {
-        for (std::vector<double> &row : layer) {
-            for (double &element : row) {
-                element = distribution(generator);
-            }
-        }
-    }
+    for_each_weight(get_mutable_weights(), [&](double &element) {
+        element = distribution(generator);
+    });
+    build_inference_weights();
 }
 
 void NeuralNet::feed_forward(const std::vector<double> &input) {
@@ -112,30 +170,197 @@ void NeuralNet::feed_forward(const std::vector<double> &input) {
     if (input.size() != neuron_counts[0]) {
         throw NeuralNetFeedForwardError();
     } else {
-        // Assign input_Neurons to match input. Last element of input_Neurons should not be touched as it is bias.
-        // For each loops not being used throughout function to avoid bias nuerons and needing iterators for
-        // accessing multiple vectors.
-        for (unsigned int i = 0; i < neuron_counts[0]; i++) {
-            neurons[0][i] = input[i];
+        // Assign input_Neurons to match input. Bias and padding after the inputs are not touched.
+        std::copy(input.begin(), input.end(), neurons.get() + neuron_offsets[0]);
+        run_layers(neurons.get() + neuron_offsets[0]);
+    }
+}
+
+void NeuralNet::feed_forward(const double *input) {
+    std::copy(input, input + neuron_counts[0], neurons.get() + neuron_offsets[0]);
+    run_layers(neurons.get() + neuron_offsets[0]);
+}
+
+void NeuralNet::feed_forward_padded(const double *input_layer) {
+    run_layers(input_layer);
+}
+
+void NeuralNet::run_layers(const double *input_layer) {
+    // Calculate through all layers with the active kernel. Each neuron is the activate of the sum of all
+    // weights*previous layer neuron value, including bias. Padding adds 0.
+    const NeuralNetLayerFunctions &layer_functions = get_active_layer_functions();
+    if (precision == NeuralNetPrecision::fp64) {
+        for (unsigned int i = 1; i < layer_count; i++) {
+            const double *previous = (i == 1) ? input_layer : neurons.get() + neuron_offsets[i - 1];
+            layer_functions.fp64(weights + weight_offsets[i - 1], previous, neurons.get() + neuron_offsets[i],
+                                 neuron_counts[i], strides[i - 1]);
+        }
+        return;
+    }
+
+    // Reduced precision. Neurons are calculated in float, and the output copied back to the master neurons.
+    float *float_neurons = neurons_fp32.get();
+    std::copy(input_layer, input_layer + neuron_counts[0], float_neurons + neuron_offsets[0]);
+
+    for (unsigned int i = 1; i < layer_count; i++) {
+        const float *previous = float_neurons + neuron_offsets[i - 1];
+        if (precision == NeuralNetPrecision::fp32) {
+            layer_functions.fp32(inference_weights->fp32.get() + weight_offsets[i - 1], previous,
+                                 float_neurons + neuron_offsets[i], neuron_counts[i], strides[i - 1]);
+        } else {
+            // Quantize the previous layer symmetrically, with one scale for the whole layer
+            float max_value = 0;
+            for (size_t k = 0; k < strides[i - 1]; k++) {
+                max_value = std::max(max_value, std::abs(previous[k]));
+            }
+            float input_scale = (max_value > 0) ? max_value / 127 : 1.0f;
+            for (size_t k = 0; k < strides[i - 1]; k++) {
+                neurons_int8.get()[k] = int8_t(std::lround(previous[k] / input_scale));
+            }
+
+            layer_functions.int8(inference_weights->int8.get() + weight_offsets[i - 1],
+                                 inference_weights->row_scales.get() + row_scale_offsets[i - 1], neurons_int8.get(),
+                                 input_scale, float_neurons + neuron_offsets[i], neuron_counts[i], strides[i - 1]);
+        }
+    }
+
+    const float *output = float_neurons + neuron_offsets[layer_count - 1];
+    std::copy(output, output + neuron_counts[layer_count - 1], neurons.get() + neuron_offsets[layer_count - 1]);
+}
+
+void NeuralNet::feed_forward_batch(const std::vector<std::vector<double>> &inputs) {
+    std::vector<const std::vector<double> *> input_pointers;
+    input_pointers.reserve(inputs.size());
+    for (const std::vector<double> &input : inputs) {
+        input_pointers.push_back(&input);
+    }
+    feed_forward_batch(input_pointers);
+}
+
+void NeuralNet::feed_forward_batch(const std::vector<const std::vector<double> *> &inputs) {
+    // Validate all inputs before touching the batch
+    for (const std::vector<double> *input : inputs) {
+        if (input->size() != neuron_counts[0]) {
+            throw NeuralNetFeedForwardError();
+        }
+    }
+
+    reserve_batch(inputs.size());
+
+    // Assign the input layer of each batch row. Bias and padding after the inputs are not touched.
+    double *batch = batch_neurons.get();
+    for (size_t b = 0; b < inputs.size(); b++) {
+        std::copy(inputs[b]->begin(), inputs[b]->end(), batch + batch_offsets[0] + b * strides[0]);
+    }
+
+    run_batch_layers(batch + batch_offsets[0], inputs.size(), strides[0]);
+}
+
+void NeuralNet::feed_forward_batch_padded(const double *input_layers, const size_t batch, const size_t input_stride) {
+    reserve_batch(batch);
+    run_batch_layers(input_layers, batch, input_stride);
+}
+
+void NeuralNet::run_batch_layers(const double *input_layers, const size_t batch, const size_t input_stride) {
+    batch_size = batch;
+    double *batch_layers = batch_neurons.get();
+
+    if (precision != NeuralNetPrecision::fp64) {
+        // Reduced precision, feed each input forward and copy the output into the batch
+        for (size_t b = 0; b < batch_size; b++) {
+            run_layers(input_layers + b * input_stride);
+            const double *output = neurons.get() + neuron_offsets[layer_count - 1];
+            std::copy(output, output + neuron_counts[layer_count - 1],
+                      batch_layers + batch_offsets[layer_count - 1] + b * strides[layer_count - 1]);
+        }
+        return;
+    }
+
+    // Calculate through all layers as matrix-matrix multiplies
+    NeuralNetBatchLayerFunction layer_function = get_active_layer_functions().fp64_batch;
+    for (unsigned int i = 1; i < layer_count; i++) {
+        const double *previous = (i == 1) ? input_layers : batch_layers + batch_offsets[i - 1];
+        layer_function(weights + weight_offsets[i - 1], previous, batch_layers + batch_offsets[i], neuron_counts[i],
+                       strides[i - 1], batch_size, (i == 1) ? input_stride : strides[i - 1], strides[i]);
+    }
+}
+
+const double *NeuralNet::get_batch_output(const size_t index) const {
+    return batch_neurons.get() + batch_offsets[layer_count - 1] + index * strides[layer_count - 1];
+}
+
+void NeuralNet::reserve_batch(const size_t i_batch_size) {
+    if (i_batch_size <= batch_capacity) {
+        return;
+    }
+
+    // Grow geometrically, so batches that increase slowly do not reallocate on every call
+    batch_capacity = std::max(i_batch_size, batch_capacity * 2);
+
+    batch_offsets.clear();
+    size_t offset = 0;
+    for (unsigned int i = 0; i < layer_count; i++) {
+        batch_offsets.push_back(offset);
+        offset += strides[i] * batch_capacity;
+    }
+    batch_neurons = NeuralNetBuffer<double>(offset);
+
+    // Set the bias neuron of each batch row to 1
+    for (unsigned int i = 0; i < layer_count - 1; i++) {
+        for (size_t b = 0; b < batch_capacity; b++) {
+            batch_neurons.get()[batch_offsets[i] + b * strides[i] + neuron_counts[i]] = 1.0;
         }
+    }
+}
 
-        // Calculate through all layers
+void NeuralNet::set_precision(const NeuralNetPrecision i_precision) {
+    if (precision != i_precision) {
+        precision = i_precision;
+        build_inference_weights();
+    }
+}
+
+NeuralNetPrecision NeuralNet::get_precision() const {
+    return precision;
+}
+
+size_t NeuralNet::get_input_stride() const {
+    return strides[0];
+}
+
+void NeuralNet::build_inference_weights() {
+    if (precision == NeuralNetPrecision::fp64) {
+        inference_weights.reset();
+        return;
+    }
+
+    // Build into a new object, as the current one may be shared with copies of the network
+    std::shared_ptr<NeuralNetInferenceWeights> built = std::make_shared<NeuralNetInferenceWeights>();
+
+    if (precision == NeuralNetPrecision::fp32) {
+        built->fp32 = NeuralNetBuffer<float>(weight_count);
+        std::copy(weights, weights + weight_count, built->fp32.get());
+    } else if (precision == NeuralNetPrecision::int8) {
+        built->int8 = NeuralNetBuffer<int8_t>(weight_count);
+        built->row_scales = NeuralNetBuffer<float>(row_scale_offsets.back() + neuron_counts[layer_count - 1]);
+        // Quantize each row symmetrically, with its own scale
         for (unsigned int i = 1; i < layer_count; i++) {
-            // For each neuron in each layer after input, calculate value
             for (unsigned int j = 0; j < neuron_counts[i]; j++) {
-                // Reset Nueron to 0 before calculating
-                neurons[i][j] = 0;
-
-                // Sum the value of all weights*previous layer neuron value
-                for (unsigned int k = 0; k <= neuron_counts[i - 1]; k++) {
-                    neurons[i][j] += neurons[i - 1][k] * weights[i - 1][j][k];
+                size_t row = weight_offsets[i - 1] + j * strides[i - 1];
+                double max_value = 0;
+                for (size_t k = 0; k < strides[i - 1]; k++) {
+                    max_value = std::max(max_value, std::abs(weights[row + k]));
+                }
+                double scale = (max_value > 0) ? max_value / 127 : 1.0;
+                built->row_scales.get()[row_scale_offsets[i - 1] + j] = float(scale);
+                for (size_t k = 0; k < strides[i - 1]; k++) {
+                    built->int8.get()[row + k] = int8_t(std::lround(weights[row + k] / scale));
                 }
-
-                // Take activate of final sum to determine value
-                neurons[i][j] = activate(neurons[i][j]);
             }
         }
     }
+
+    inference_weights = built;
 }
 
 void NeuralNet::mutate(const double &radius) {
@@ -147,17 +372,19 @@ void NeuralNet::mutate(const double &radius) {
     std::uniform_real_distribution<double> distribution(-radius, radius);
 
     // Mutate each element in each row of weight tables by random values in uniform distribution
-    for (std::vector<std::vector<double>> &layer : weights) {
-        for (std::vector<double> &row : layer) {
-            for (double &element : row) {
-                element += distribution(generator);
-            }
-        }
-    }
+    for_each_weight(get_mutable_weights(), [&](double &element) {
+        element += distribution(generator);
+    });
+    build_inference_weights();
 }
 
 std::vector<double> NeuralNet::get_output() const {
-    return neurons[layer_count - 1];
+    const double *output = neurons.get() + neuron_offsets[layer_count - 1];
+    return std::vector<double>(output, output + neuron_counts[layer_count - 1]);
+}
+
+double NeuralNet::get_output_value(const unsigned int index) const {
+    return neurons.get()[neuron_offsets[layer_count - 1] + index];
 }
 
 void NeuralNet::export_weights_stream(std::ofstream &file) {
@@ -171,14 +398,10 @@ void NeuralNet::export_weights_stream(std::ofstream &file) {
         }
         file << std::endl;
 
-        for (unsigned int i = 0; i < layer_count - 1; i++) {
-            for (std::vector<double> &row : weights[i]) {
-                for (double &element : row) {
-                    converter.d = element;
-                    file << converter.i << ",";
-                }
-            }
-        }
+        for_each_weight(weights, [&](const double &element) {
+            converter.d = element;
+            file << converter.i << ",";
+        });
         // Newline for parsing on import
         file << std::endl;
     } else {
@@ -195,8 +418,8 @@ void NeuralNet::import_weights_stream(std::ifstream &file) {
     // Import weight values
     unsigned int import_layer_count;
     std::vector<unsigned int> import_layer_neuron_count;
-    // Vector to hold imported values
-    std::vector<std::vector<std::vector<double>>> import_weights;
+    // Vector to hold imported values, in export order
+    std::vector<double> import_weights;
 
     // String and stringstream for converting data
     std::string line;
@@ -212,8 +435,6 @@ void NeuralNet::import_weights_stream(std::ifstream &file) {
         throw NeuralNetImportError();
     }
 
-    import_weights.resize(layer_count - 1);
-
     // Get layer neuron counts
     getline(file, line, '\n');
     layer_stream.str(line);
@@ -242,34 +463,74 @@ void NeuralNet::import_weights_stream(std::ifstream &file) {
     // DoubleInt Union converter for importing doubles stored as ints
     DoubleInt converter;
 
-    // Assign/Resize Weight Vectors to appropriate size [x][y] and initialize elements to 0.
-    // +1 is to account for bias
-    for (unsigned int i = 1; i < layer_count; i++) {
-        import_weights[i - 1].resize(neuron_counts[i]);
-
-        for (std::vector<double> &row : import_weights[i - 1]) {
-            row.assign(neuron_counts[i - 1] + 1, 0);
-        }
-    }
-
     // Get line with weights
     getline(file, line, '\n');
     weight_stream.str(line);
 
-    // Import Weights
-    for (unsigned int i = 0; i < layer_count - 1; i++) {
-        for (std::vector<double> &row : import_weights[i]) {
-            for (double &element : row) {
-                if (!getline(weight_stream, line_element, ',')) {
-                    // Malformed, ran out of input
-                    throw NeuralNetImportError();
-                }
-                converter.i = std::stoll(line_element);
-                element = converter.d;
+    // Import Weights. Neuron counts match, so there is one weight per bias and non bias neuron pair.
+    for (unsigned int i = 1; i < layer_count; i++) {
+        for (unsigned int j = 0; j < neuron_counts[i] * (neuron_counts[i - 1] + 1); j++) {
+            if (!getline(weight_stream, line_element, ',')) {
+                // Malformed, ran out of input
+                throw NeuralNetImportError();
             }
+            converter.i = std::stoll(line_element);
+            import_weights.push_back(converter.d);
         }
     }
 
-    // Convert imported values to weight vectors
-    weights = import_weights;
+    // Copy imported values to the weight matrices
+    std::vector<double>::const_iterator imported = import_weights.begin();
+    for_each_weight(get_mutable_weights(), [&imported](double &element) {
+        element = *imported++;
+    });
+    build_inference_weights();
+}
+
+void NeuralNet::export_weights_binary(NeuralNetWeightFileWriter &writer) const {
+    writer.add(neuron_counts, precision, weights, weight_count);
+}
+
+void NeuralNet::import_weights_binary(const std::shared_ptr<const NeuralNetWeightFile> &file, size_t &index) {
+    if (index >= file->get_network_count()) {
+        std::cout << "Weight file has no network " << index << ".\n";
+        throw NeuralNetImportError();
+    }
+
+    // Check that the topology and padded layout match
+    if ((file->get_neuron_counts(index) != neuron_counts) || (file->get_weight_count(index) != weight_count)) {
+        std::cout << "Weight file network " << index << " does not match.\n";
+        throw NeuralNetImportError();
+    }
+
+    // Borrow the weights in place, and release owned weights
+    weight_file = file;
+    weights = file->get_weights(index);
+    weight_buffer.reset();
+    precision = file->get_precision(index);
+    build_inference_weights();
+    index++;
+}
+
+bool NeuralNet::check_weights_borrowed() const {
+    return bool(weight_file);
+}
+
+const std::vector<unsigned int> &NeuralNet::get_neuron_counts() const {
+    return neuron_counts;
+}
+
+bool NeuralNet::check_weights_shared() const {
+    return weight_file ? (weight_file.use_count() > 1) : (weight_buffer.use_count() > 1);
+}
+
+double *NeuralNet::get_mutable_weights() {
+    // use_count is not used to skip the copy. Another thread may be copying this network, so a count of 1 does not
+    // prove the buffer is unshared. Modifications read or overwrite every weight, so the copy adds little.
+    std::shared_ptr<NeuralNetBuffer<double>> copy = std::make_shared<NeuralNetBuffer<double>>(weight_count);
+    std::copy(weights, weights + weight_count, copy->get());
+    weight_buffer = copy;
+    weights = weight_buffer->get();
+    weight_file.reset();
+    return weight_buffer->get();
 }
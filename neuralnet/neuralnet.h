@@ -4,9 +4,20 @@
 #ifndef NEURALNET_NEURALNET_H_
 #define NEURALNET_NEURALNET_H_
 
+#include <algorithm>
 #include <vector>
+#include <memory>
 #include <fstream>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+// Alignment of the NeuralNet buffer in bytes, one cache line
+#define NEURALNET_ALIGNMENT 64
+// Rows in the NeuralNet buffer are padded to a multiple of this many doubles, so every row starts on a cache line
+#define NEURALNET_SIMD_WIDTH 8
 
 class NeuralNetFeedForwardError : public std::runtime_error {
  public:
@@ -23,6 +34,9 @@ class NeuralNetImportError : public std::runtime_error {
     NeuralNetImportError() : std::runtime_error("NeuralNetImportError") { }
 };
 
+class NeuralNetWeightFile;
+class NeuralNetWeightFileWriter;
+
 // Support function for calculating activate.
 // Declared inline as it is only 1 line to increase speed.
 inline double activate(double x) {
@@ -35,17 +49,166 @@ union DoubleInt {
     double d;
 };
 
+// Inference precision of NeuralNet::feed_forward. Master weights are always held as double.
+enum class NeuralNetPrecision : uint8_t {
+    // Double weights and neurons
+    fp64,
+    // Float weights and neurons
+    fp32,
+    // int8 weights with a float scale per row, int8 neurons with a float scale per layer, int32 sums
+    int8
+};
+
+// Class for holding a zero initialized, NEURALNET_ALIGNMENT aligned array. Copies are a single memcpy.
+// T must be trivially copyable.
+template <typename T>
+class NeuralNetBuffer {
+ private:
+    // Allocated storage, with room to align data
+    std::unique_ptr<char[]> storage;
+    // Aligned start of the array
+    T *data;
+    // Number of elements
+    size_t length;
+
+ public:
+    // Constructor with length specification. All elements are initialized to 0.
+    explicit NeuralNetBuffer(const size_t i_length = 0) : storage(new char[i_length * sizeof(T) +
+                                                                           NEURALNET_ALIGNMENT]()),
+                                                          length(i_length) {
+        // Align data within storage
+        uintptr_t address = reinterpret_cast<uintptr_t>(storage.get());
+        address = (address + NEURALNET_ALIGNMENT - 1) & ~uintptr_t(NEURALNET_ALIGNMENT - 1);
+        data = reinterpret_cast<T *>(address);
+    }
+
+    // Copy Constructor
+    NeuralNetBuffer(const NeuralNetBuffer &i_buffer) : NeuralNetBuffer(i_buffer.length) {
+        std::memcpy(data, i_buffer.data, length * sizeof(T));
+    }
+
+    // Copy operator
+    NeuralNetBuffer &operator=(const NeuralNetBuffer &i_buffer) {
+        if (this != &i_buffer) {
+            // Only reallocate if the length changes
+            if (length != i_buffer.length) {
+                NeuralNetBuffer resized(i_buffer.length);
+                storage.swap(resized.storage);
+                std::swap(data, resized.data);
+                std::swap(length, resized.length);
+            }
+            std::memcpy(data, i_buffer.data, length * sizeof(T));
+        }
+        return *this;
+    }
+
+    // Function to get the aligned array
+    inline T *get() {
+        return data;
+    }
+
+    inline const T *get() const {
+        return data;
+    }
+
+    // Function to get the number of elements
+    inline size_t size() const {
+        return length;
+    }
+};
+
+// Struct for holding the reduced precision weights of a NeuralNet, built from the master weights
+struct NeuralNetInferenceWeights {
+    // Float weights, with the same layout as the master weights. Only built at fp32.
+    NeuralNetBuffer<float> fp32;
+    // int8 weights, with the same layout as the master weights, and the scale of each row. Only built at int8.
+    NeuralNetBuffer<int8_t> int8;
+    NeuralNetBuffer<float> row_scales;
+};
+
 // NeuralNet class definition
+// Weights and neurons are held in aligned buffers. Each layer's weights are a row major matrix with one row per
+// neuron, and the bias weight as the last column. Rows and neuron layers are padded with zeros to a multiple of
+// NEURALNET_SIMD_WIDTH.
+// Weights are immutable once shared. Copies of a network share its weights and only own their neurons, so a copy per
+// thread costs scratch space rather than a copy of the weights. Every modification is written to a new copy of the
+// weights, as whether another network shares them cannot be told reliably while other threads copy networks. Weights
+// may also be borrowed in place from a memory mapped NeuralNetWeightFile.
 class NeuralNet {
  private:
     // Number of layers. Must be at least 2.
     unsigned int layer_count;
     // Number on Neurons for each layer
     std::vector<unsigned int> neuron_counts;
-    // Neurons
-    std::vector<std::vector<double>> neurons;
-    // Weights
-    std::vector<std::vector<std::vector<double>>> weights;
+    // Padded length of each neuron layer, including the bias neuron for all but the output layer.
+    // Also the row length of the weights from each layer to the next.
+    std::vector<size_t> strides;
+    // Offset of each layer's weight matrix in the buffer. weight_offsets[i] holds weights from layer i to i + 1.
+    std::vector<size_t> weight_offsets;
+    // Offset of each neuron layer in neurons
+    std::vector<size_t> neuron_offsets;
+    // Number of doubles used by weights
+    size_t weight_count;
+    // Owned weights, shared between copies. Never modified once set. Null while the weights are borrowed.
+    std::shared_ptr<NeuralNetBuffer<double>> weight_buffer;
+    // Weights used by feed_forward. Points into weight_buffer, or into weight_file.
+    const double *weights;
+    // Weight file the weights are borrowed from, kept mapped while in use. Null if the weights are owned.
+    std::shared_ptr<const NeuralNetWeightFile> weight_file;
+    // Neurons, scratch space for feed_forward
+    NeuralNetBuffer<double> neurons;
+
+    // Inference precision
+    NeuralNetPrecision precision;
+    // Reduced precision weights for the current precision, shared between copies. Null at fp64. Rebuilt as soon as
+    // the precision or master weights change, so copies share them rather than each building their own. Replaced,
+    // never modified, when rebuilt.
+    std::shared_ptr<const NeuralNetInferenceWeights> inference_weights;
+    // Offset of each layer's row scales in the inference row scales
+    std::vector<size_t> row_scale_offsets;
+    // Float neurons, with the same layout as the master neurons. Used at fp32 and int8.
+    NeuralNetBuffer<float> neurons_fp32;
+    // Quantized neurons of the layer being fed forward. Used at int8.
+    NeuralNetBuffer<int8_t> neurons_int8;
+
+    // Batch neurons. Each layer holds one padded row per input, at batch_offsets[layer].
+    NeuralNetBuffer<double> batch_neurons;
+    std::vector<size_t> batch_offsets;
+    // Number of inputs batch_neurons has room for
+    size_t batch_capacity;
+    // Number of inputs of the last feed_forward_batch
+    size_t batch_size;
+
+    // Function to grow batch_neurons to hold at least i_batch_size inputs
+    void reserve_batch(const size_t i_batch_size);
+
+    // Function to calculate through all layers from a padded input layer
+    void run_layers(const double *input_layer);
+
+    // Function to calculate through all layers for batch padded input layers, input_stride apart
+    void run_batch_layers(const double *input_layers, const size_t batch, const size_t input_stride);
+
+    // Function to rebuild the reduced precision weights for the current precision from the master weights. Called on
+    // every change of the precision or master weights.
+    void build_inference_weights();
+
+    // Function to get the weights for modification. The current weights are copied into a new weight_buffer, owned
+    // by this network alone, which becomes the weights.
+    double *get_mutable_weights();
+
+    // Function to call function with a reference to each weight of matrices, in import/export order.
+    // matrices has the layout of the weights. Padding is skipped.
+    template <typename T, typename Function>
+    void for_each_weight(T *matrices, Function function) const {
+        for (unsigned int i = 0; i < layer_count - 1; i++) {
+            T *matrix = matrices + weight_offsets[i];
+            for (unsigned int j = 0; j < neuron_counts[i + 1]; j++) {
+                for (unsigned int k = 0; k <= neuron_counts[i]; k++) {
+                    function(matrix[j * strides[i] + k]);
+                }
+            }
+        }
+    }
 
  public:
     // Default Constructor
@@ -75,17 +238,70 @@ class NeuralNet {
     // FeedForward Function, calculate output based on inputs.
     void feed_forward(const std::vector<double> &input);
 
+    // FeedForward Function, reading one value per input neuron from input. Does not allocate.
+    void feed_forward(const double *input);
+
+    // FeedForward Function, reading the input layer in place. input_layer must be laid out as the padded input layer:
+    // get_input_stride() values, NEURALNET_ALIGNMENT aligned, with the bias neuron after the inputs set to 1 and the
+    // padding set to 0. Does not allocate.
+    void feed_forward_padded(const double *input_layer);
+
     // Mutator. Randomly mutates
     void mutate(const double &radius);
 
     // Get output
     std::vector<double> get_output() const;
 
+    // Function to get one output neuron without copying the output layer
+    double get_output_value(const unsigned int index) const;
+
+    // Batch FeedForward Function. Calculates the output of each input, loading each weight matrix once per layer for
+    // the whole batch. Only fp64 is batched; other precisions feed each input forward in turn.
+    void feed_forward_batch(const std::vector<std::vector<double>> &inputs);
+
+    // Batch FeedForward Function, taking pointers to the inputs so callers can batch inputs without copying them
+    void feed_forward_batch(const std::vector<const std::vector<double> *> &inputs);
+
+    // Batch FeedForward Function, reading batch padded input layers in place, input_stride values apart. Each input
+    // layer is laid out as for feed_forward_padded. input_stride must be a multiple of NEURALNET_SIMD_WIDTH.
+    void feed_forward_batch_padded(const double *input_layers, const size_t batch, const size_t input_stride);
+
+    // Function to get the output layer of one input of the last feed_forward_batch.
+    // The returned array is valid until the next feed_forward_batch.
+    const double *get_batch_output(const size_t index) const;
+
+    // Function to set the inference precision of feed_forward. Weights are converted at once, so copies made after
+    // share them.
+    void set_precision(const NeuralNetPrecision i_precision);
+
+    // Function to get the inference precision
+    NeuralNetPrecision get_precision() const;
+
+    // Function to get the padded length of the input layer, including the bias neuron
+    size_t get_input_stride() const;
+
     // Export weights to specified ofstream
     void export_weights_stream(std::ofstream &file);
 
     // Import weights from specified file. Each weight set needs to be CSV on a single line
     void import_weights_stream(std::ifstream &file);
+
+    // Export weights and precision to a binary weight file
+    void export_weights_binary(NeuralNetWeightFileWriter &writer) const;
+
+    // Borrow the weights of network index of a binary weight file in place, without copying them, and take its
+    // precision. Increments index. Throws NeuralNetImportError if the topology does not match.
+    void import_weights_binary(const std::shared_ptr<const NeuralNetWeightFile> &file, size_t &index);
+
+    // Function to check if the weights are borrowed from a weight file
+    bool check_weights_borrowed() const;
+
+    // Function to check if the weights are shared with another network. Only approximate while other threads copy
+    // or destroy networks sharing the weights, so it is for tests and reporting, not for deciding to modify them.
+    bool check_weights_shared() const;
+
+    // Function to get the neuron count of each layer
+    const std::vector<unsigned int> &get_neuron_counts() const;
 };
 
 #endif  // NEURALNET_NEURALNET_H_
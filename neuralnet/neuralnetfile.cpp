@@ -0,0 +1,212 @@
+// Copyright [2016] <duncan@wduncanfraser.com>
+// Implementation of the binary NeuralNet weight file format
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "neuralnetfile.h"
+
+#define FNV_OFFSET_BASIS 14695981039346656037ull
+#define FNV_PRIME 1099511628211ull
+
+// Function to round a byte count up to a multiple of NEURALNET_ALIGNMENT
+static inline size_t get_aligned_length(const size_t length) {
+    return (length + NEURALNET_ALIGNMENT - 1) / NEURALNET_ALIGNMENT * NEURALNET_ALIGNMENT;
+}
+
+// Function to get the length of a network header, neuron counts and padding
+static inline size_t get_network_header_length(const size_t layer_count) {
+    return get_aligned_length(sizeof(NeuralNetFileNetworkHeader) + layer_count * sizeof(uint32_t));
+}
+
+uint64_t get_weight_file_checksum(const void *data, const size_t length, uint64_t checksum) {
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    for (size_t i = 0; i < length; i += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, bytes + i, sizeof(uint64_t));
+        checksum = (checksum ^ word) * FNV_PRIME;
+    }
+    return checksum;
+}
+
+bool check_weight_file(const std::string &path) {
+    std::ifstream file(path, std::ifstream::binary);
+    char magic[sizeof(NEURALNET_FILE_MAGIC)];
+    return file.read(magic, sizeof(magic)) && (std::memcmp(magic, NEURALNET_FILE_MAGIC, sizeof(magic)) == 0);
+}
+
+NeuralNetWeightFile::NeuralNetWeightFile(const std::string &path, const bool verify_checksum) : mapping(nullptr),
+                                                                                               length(0) {
+    int descriptor = open(path.c_str(), O_RDONLY);
+    if (descriptor < 0) {
+        std::cout << "Weight file " << path << " failed to open.\n";
+        throw NeuralNetImportError();
+    }
+
+    struct stat file_stat;
+    if ((fstat(descriptor, &file_stat) != 0) || (size_t(file_stat.st_size) < sizeof(NeuralNetFileHeader))) {
+        ::close(descriptor);
+        throw NeuralNetImportError();
+    }
+    length = size_t(file_stat.st_size);
+
+    // The mapping stays valid after the descriptor is closed
+    mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    ::close(descriptor);
+    if (mapping == MAP_FAILED) {
+        mapping = nullptr;
+        throw NeuralNetImportError();
+    }
+
+    try {
+        const char *data = static_cast<const char *>(mapping);
+        const NeuralNetFileHeader *header = reinterpret_cast<const NeuralNetFileHeader *>(data);
+
+        if ((std::memcmp(header->magic, NEURALNET_FILE_MAGIC, sizeof(header->magic)) != 0) ||
+            (header->version != NEURALNET_FILE_VERSION) || (header->byte_order != NEURALNET_FILE_BYTE_ORDER) ||
+            (header->simd_width != NEURALNET_SIMD_WIDTH) || (header->file_length != length)) {
+            std::cout << "Weight file " << path << " has an unsupported header.\n";
+            throw NeuralNetImportError();
+        }
+
+        if (verify_checksum && (get_weight_file_checksum(data + sizeof(NeuralNetFileHeader),
+                                                         length - sizeof(NeuralNetFileHeader),
+                                                         FNV_OFFSET_BASIS) != header->checksum)) {
+            std::cout << "Weight file " << path << " failed its checksum.\n";
+            throw NeuralNetImportError();
+        }
+
+        // Walk the network records, checking each lies within the file
+        size_t offset = sizeof(NeuralNetFileHeader);
+        for (uint32_t i = 0; i < header->network_count; i++) {
+            if (offset + sizeof(NeuralNetFileNetworkHeader) > length) {
+                throw NeuralNetImportError();
+            }
+            const NeuralNetFileNetworkHeader *network_header =
+                    reinterpret_cast<const NeuralNetFileNetworkHeader *>(data + offset);
+            size_t header_length = get_network_header_length(network_header->layer_count);
+            if ((network_header->layer_count < 2) || (offset + header_length > length) ||
+                (network_header->weight_count > (length - offset - header_length) / sizeof(double)) ||
+                (network_header->precision > uint32_t(NeuralNetPrecision::int8))) {
+                throw NeuralNetImportError();
+            }
+
+            const uint32_t *neuron_counts = reinterpret_cast<const uint32_t *>(network_header + 1);
+            Network network;
+            network.neuron_counts.assign(neuron_counts, neuron_counts + network_header->layer_count);
+            network.precision = NeuralNetPrecision(network_header->precision);
+            network.weights = reinterpret_cast<const double *>(data + offset + header_length);
+            network.weight_count = size_t(network_header->weight_count);
+            networks.push_back(network);
+
+            offset += header_length + get_aligned_length(network.weight_count * sizeof(double));
+        }
+    } catch (...) {
+        munmap(mapping, length);
+        throw;
+    }
+}
+
+NeuralNetWeightFile::~NeuralNetWeightFile() {
+    if (mapping != nullptr) {
+        munmap(mapping, length);
+    }
+}
+
+size_t NeuralNetWeightFile::get_network_count() const {
+    return networks.size();
+}
+
+const std::vector<unsigned int> &NeuralNetWeightFile::get_neuron_counts(const size_t index) const {
+    return networks.at(index).neuron_counts;
+}
+
+NeuralNetPrecision NeuralNetWeightFile::get_precision(const size_t index) const {
+    return networks.at(index).precision;
+}
+
+const double *NeuralNetWeightFile::get_weights(const size_t index) const {
+    return networks.at(index).weights;
+}
+
+size_t NeuralNetWeightFile::get_weight_count(const size_t index) const {
+    return networks.at(index).weight_count;
+}
+
+// Suffix of the file written by NeuralNetWeightFileWriter until it is closed
+#define NEURALNET_FILE_TEMP_SUFFIX ".tmp"
+
+NeuralNetWeightFileWriter::NeuralNetWeightFileWriter(const std::string &i_path) :
+        path(i_path), file(i_path + NEURALNET_FILE_TEMP_SUFFIX, std::ofstream::out | std::ofstream::binary),
+        network_count(0), length(sizeof(NeuralNetFileHeader)), checksum(FNV_OFFSET_BASIS) {
+    if (!file.is_open()) {
+        throw NeuralNetExportError();
+    }
+
+    // Reserve the header with zeros
+    NeuralNetFileHeader header = {};
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+}
+
+void NeuralNetWeightFileWriter::write_block(const void *data, const size_t block_length) {
+    file.write(static_cast<const char *>(data), block_length);
+    checksum = get_weight_file_checksum(data, block_length, checksum);
+    length += block_length;
+}
+
+void NeuralNetWeightFileWriter::add(const std::vector<unsigned int> &neuron_counts,
+                                    const NeuralNetPrecision precision, const double *weights,
+                                    const size_t weight_count) {
+    if (!file.is_open()) {
+        throw NeuralNetExportError();
+    }
+
+    // Network header, neuron counts and padding
+    std::vector<char> header(get_network_header_length(neuron_counts.size()), 0);
+    NeuralNetFileNetworkHeader network_header = {uint32_t(neuron_counts.size()), uint32_t(precision),
+                                                 uint64_t(weight_count)};
+    std::memcpy(header.data(), &network_header, sizeof(network_header));
+    for (size_t i = 0; i < neuron_counts.size(); i++) {
+        uint32_t neuron_count = neuron_counts[i];
+        std::memcpy(header.data() + sizeof(network_header) + i * sizeof(uint32_t), &neuron_count, sizeof(uint32_t));
+    }
+    write_block(header.data(), header.size());
+
+    // Weights, padded to the next network
+    write_block(weights, weight_count * sizeof(double));
+    std::vector<char> padding(get_aligned_length(weight_count * sizeof(double)) - weight_count * sizeof(double), 0);
+    write_block(padding.data(), padding.size());
+
+    network_count++;
+}
+
+void NeuralNetWeightFileWriter::close() {
+    if (!file.is_open()) {
+        throw NeuralNetExportError();
+    }
+
+    NeuralNetFileHeader header = {};
+    std::memcpy(header.magic, NEURALNET_FILE_MAGIC, sizeof(header.magic));
+    header.version = NEURALNET_FILE_VERSION;
+    header.byte_order = NEURALNET_FILE_BYTE_ORDER;
+    header.simd_width = NEURALNET_SIMD_WIDTH;
+    header.network_count = network_count;
+    header.file_length = length;
+    header.checksum = checksum;
+
+    file.seekp(0);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.close();
+    if (file.fail() || (std::rename((path + NEURALNET_FILE_TEMP_SUFFIX).c_str(), path.c_str()) != 0)) {
+        throw NeuralNetExportError();
+    }
+}
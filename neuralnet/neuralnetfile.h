@@ -0,0 +1,123 @@
+// Copyright [2016] <duncan@wduncanfraser.com>
+// Prototypes for the binary NeuralNet weight file format, read in place through a memory mapping
+
+#ifndef NEURALNET_NEURALNETFILE_H_
+#define NEURALNET_NEURALNETFILE_H_
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstddef>
+#include <cstdint>
+
+#include "neuralnet.h"
+
+// First 8 bytes of a binary weight file
+#define NEURALNET_FILE_MAGIC "SGNNWTS"
+// Current format version
+#define NEURALNET_FILE_VERSION 1
+// Written in native byte order, so files from a machine of the other endianness are rejected
+#define NEURALNET_FILE_BYTE_ORDER 0x01020304
+
+// Binary weight file layout. All values are native endian.
+// The file starts with a NeuralNetFileHeader. Each network follows, starting on a NEURALNET_ALIGNMENT boundary: a
+// NeuralNetFileNetworkHeader, layer_count uint32 neuron counts, zero padding to NEURALNET_ALIGNMENT, then weight_count
+// doubles holding the weight matrices exactly as NeuralNet lays them out. Networks can then use the weights in place.
+// The checksum covers every byte after the file header.
+struct NeuralNetFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    // NEURALNET_SIMD_WIDTH of the writer, which determines the weight row padding
+    uint32_t simd_width;
+    uint32_t network_count;
+    // Length of the whole file in bytes
+    uint64_t file_length;
+    uint64_t checksum;
+    uint8_t reserved[24];
+};
+
+static_assert(sizeof(NeuralNetFileHeader) == NEURALNET_ALIGNMENT, "NeuralNetFileHeader must fill one alignment block");
+
+struct NeuralNetFileNetworkHeader {
+    uint32_t layer_count;
+    // NeuralNetPrecision of the network
+    uint32_t precision;
+    // Number of doubles in the weight matrices, including padding
+    uint64_t weight_count;
+};
+
+// Function to update checksum with a block of the weight file, as FNV-1a over 64 bit words.
+// length must be a multiple of 8.
+uint64_t get_weight_file_checksum(const void *data, const size_t length, uint64_t checksum);
+
+// Function to check if the file at path is a binary weight file, by its magic
+bool check_weight_file(const std::string &path);
+
+// Class for a binary weight file, mapped read only into memory. Networks borrow their weights in place through
+// NeuralNet::import_weights_binary, and hold a shared pointer to the file while they do.
+class NeuralNetWeightFile {
+ private:
+    // Struct for holding the location and topology of one network in the mapping
+    struct Network {
+        std::vector<unsigned int> neuron_counts;
+        NeuralNetPrecision precision;
+        const double *weights;
+        size_t weight_count;
+    };
+
+    // Mapped file
+    void *mapping;
+    size_t length;
+
+    std::vector<Network> networks;
+
+ public:
+    // Constructor mapping the file at path. Throws NeuralNetImportError if the file can not be mapped, or is not a
+    // valid weight file. The checksum is verified if verify_checksum is set, which reads the whole file.
+    explicit NeuralNetWeightFile(const std::string &path, const bool verify_checksum = true);
+
+    NeuralNetWeightFile(const NeuralNetWeightFile &) = delete;
+    NeuralNetWeightFile &operator=(const NeuralNetWeightFile &) = delete;
+
+    // Destructor. Unmaps the file.
+    ~NeuralNetWeightFile();
+
+    // Function to get the number of networks in the file
+    size_t get_network_count() const;
+
+    // Functions to get the topology, precision and weights of network index
+    const std::vector<unsigned int> &get_neuron_counts(const size_t index) const;
+    NeuralNetPrecision get_precision(const size_t index) const;
+    const double *get_weights(const size_t index) const;
+    size_t get_weight_count(const size_t index) const;
+};
+
+// Class for writing a binary weight file. Networks are appended in order through NeuralNet::export_weights_binary.
+// The file is written beside path and renamed over it by close, so networks still borrowing from a mapping of an
+// earlier file at path are not disturbed, and a file that was not closed never replaces it.
+class NeuralNetWeightFileWriter {
+ private:
+    std::string path;
+    std::ofstream file;
+    uint32_t network_count;
+    uint64_t length;
+    uint64_t checksum;
+
+    // Function to write a block after the header, updating the checksum. length must be a multiple of 8.
+    void write_block(const void *data, const size_t block_length);
+
+ public:
+    // Constructor opening the file at path. Throws NeuralNetExportError if it can not be opened.
+    explicit NeuralNetWeightFileWriter(const std::string &i_path);
+
+    // Function to append a network. weights holds weight_count doubles in the NeuralNet weight layout.
+    void add(const std::vector<unsigned int> &neuron_counts, const NeuralNetPrecision precision,
+             const double *weights, const size_t weight_count);
+
+    // Function to write the header, close the file and move it to path. Throws NeuralNetExportError if writing
+    // failed.
+    void close();
+};
+
+#endif  // NEURALNET_NEURALNETFILE_H_
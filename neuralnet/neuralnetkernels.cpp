@@ -0,0 +1,499 @@
+// Copyright [2016] <duncan@wduncanfraser.com>
+// Implementation of the NeuralNet layer kernels, with runtime CPU dispatch
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include "neuralnet.h"
+#include "neuralnetkernels.h"
+
+// x86 kernels are built with per function target attributes, so the library itself needs no special flags
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define NEURALNET_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+// Scalar reference kernel
+static void layer_scalar(const double *matrix, const double *input, double *output, const size_t rows,
+                         const size_t stride) {
+    for (size_t j = 0; j < rows; j++) {
+        const double *row = matrix + j * stride;
+        double sum = 0;
+
+        for (size_t k = 0; k < stride; k++) {
+            sum += input[k] * row[k];
+        }
+
+        output[j] = activate(sum);
+    }
+}
+
+// Scalar batch kernel. Each weight row is used for the whole batch while it is in cache.
+static void layer_batch_scalar(const double *matrix, const double *inputs, double *outputs, const size_t rows,
+                               const size_t stride, const size_t batch, const size_t input_stride,
+                               const size_t output_stride) {
+    for (size_t j = 0; j < rows; j++) {
+        const double *row = matrix + j * stride;
+
+        for (size_t b = 0; b < batch; b++) {
+            const double *input = inputs + b * input_stride;
+            double sum = 0;
+
+            for (size_t k = 0; k < stride; k++) {
+                sum += input[k] * row[k];
+            }
+
+            outputs[b * output_stride + j] = activate(sum);
+        }
+    }
+}
+
+// Function to calculate softsign activate in single precision
+static inline float activate_fp32(const float x) {
+    return x / (1 + std::abs(x));
+}
+
+// Scalar single precision kernel
+static void layer_scalar_fp32(const float *matrix, const float *input, float *output, const size_t rows,
+                              const size_t stride) {
+    for (size_t j = 0; j < rows; j++) {
+        const float *row = matrix + j * stride;
+        float sum = 0;
+
+        for (size_t k = 0; k < stride; k++) {
+            sum += input[k] * row[k];
+        }
+
+        output[j] = activate_fp32(sum);
+    }
+}
+
+// Scalar int8 kernel
+static void layer_scalar_int8(const int8_t *matrix, const float *row_scales, const int8_t *input,
+                              const float input_scale, float *output, const size_t rows, const size_t stride) {
+    for (size_t j = 0; j < rows; j++) {
+        const int8_t *row = matrix + j * stride;
+        int32_t sum = 0;
+
+        for (size_t k = 0; k < stride; k++) {
+            sum += int32_t(input[k]) * int32_t(row[k]);
+        }
+
+        output[j] = activate_fp32(float(sum) * row_scales[j] * input_scale);
+    }
+}
+
+#ifdef NEURALNET_X86_KERNELS
+
+__attribute__((target("sse4.2")))
+static void layer_sse42(const double *matrix, const double *input, double *output, const size_t rows,
+                        const size_t stride) {
+    const __m128d sign_mask = _mm_set1_pd(-0.0);
+    const __m128d one = _mm_set1_pd(1.0);
+
+    for (size_t j = 0; j < rows; j++) {
+        const double *row = matrix + j * stride;
+        __m128d sum_1 = _mm_setzero_pd();
+        __m128d sum_2 = _mm_setzero_pd();
+
+        for (size_t k = 0; k < stride; k += 4) {
+            sum_1 = _mm_add_pd(sum_1, _mm_mul_pd(_mm_load_pd(input + k), _mm_load_pd(row + k)));
+            sum_2 = _mm_add_pd(sum_2, _mm_mul_pd(_mm_load_pd(input + k + 2), _mm_load_pd(row + k + 2)));
+        }
+
+        // Horizontal sum, then softsign
+        __m128d sum = _mm_add_pd(sum_1, sum_2);
+        sum = _mm_add_sd(sum, _mm_unpackhi_pd(sum, sum));
+        sum = _mm_div_sd(sum, _mm_add_sd(one, _mm_andnot_pd(sign_mask, sum)));
+        _mm_store_sd(output + j, sum);
+    }
+}
+
+__attribute__((target("sse4.2")))
+static void layer_sse42_fp32(const float *matrix, const float *input, float *output, const size_t rows,
+                             const size_t stride) {
+    for (size_t j = 0; j < rows; j++) {
+        const float *row = matrix + j * stride;
+        __m128 sum = _mm_setzero_ps();
+
+        for (size_t k = 0; k < stride; k += 4) {
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_load_ps(input + k), _mm_load_ps(row + k)));
+        }
+
+        // Horizontal sum
+        sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+        sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+        output[j] = activate_fp32(_mm_cvtss_f32(sum));
+    }
+}
+
+__attribute__((target("sse4.2")))
+static void layer_sse42_int8(const int8_t *matrix, const float *row_scales, const int8_t *input,
+                             const float input_scale, float *output, const size_t rows, const size_t stride) {
+    for (size_t j = 0; j < rows; j++) {
+        const int8_t *row = matrix + j * stride;
+        __m128i sum = _mm_setzero_si128();
+
+        // Sign extend 8 values at a time to int16, and multiply add pairs into int32
+        for (size_t k = 0; k < stride; k += 8) {
+            __m128i in = _mm_cvtepi8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(input + k)));
+            __m128i weight = _mm_cvtepi8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(row + k)));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(in, weight));
+        }
+
+        // Horizontal sum
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4e));
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xb1));
+        output[j] = activate_fp32(float(_mm_cvtsi128_si32(sum)) * row_scales[j] * input_scale);
+    }
+}
+
+// Function to sum the four lanes of vector
+__attribute__((target("avx2")))
+static inline double reduce_add_avx2(const __m256d vector) {
+    __m128d sum = _mm_add_pd(_mm256_castpd256_pd128(vector), _mm256_extractf128_pd(vector, 1));
+    sum = _mm_add_sd(sum, _mm_unpackhi_pd(sum, sum));
+    return _mm_cvtsd_f64(sum);
+}
+
+__attribute__((target("avx2,fma")))
+static void layer_avx2(const double *matrix, const double *input, double *output, const size_t rows,
+                       const size_t stride) {
+    const __m256d sign_mask = _mm256_set1_pd(-0.0);
+    const __m256d one = _mm256_set1_pd(1.0);
+    size_t j = 0;
+
+    // Four rows at a time, so the four sums can be activated together
+    for (; j + 4 <= rows; j += 4) {
+        const double *row = matrix + j * stride;
+        __m256d sum_0 = _mm256_setzero_pd();
+        __m256d sum_1 = _mm256_setzero_pd();
+        __m256d sum_2 = _mm256_setzero_pd();
+        __m256d sum_3 = _mm256_setzero_pd();
+
+        for (size_t k = 0; k < stride; k += 4) {
+            __m256d in = _mm256_load_pd(input + k);
+            sum_0 = _mm256_fmadd_pd(in, _mm256_load_pd(row + k), sum_0);
+            sum_1 = _mm256_fmadd_pd(in, _mm256_load_pd(row + stride + k), sum_1);
+            sum_2 = _mm256_fmadd_pd(in, _mm256_load_pd(row + 2 * stride + k), sum_2);
+            sum_3 = _mm256_fmadd_pd(in, _mm256_load_pd(row + 3 * stride + k), sum_3);
+        }
+
+        // Transpose reduce the four sums into one vector, one lane per row
+        __m256d pair_01 = _mm256_hadd_pd(sum_0, sum_1);
+        __m256d pair_23 = _mm256_hadd_pd(sum_2, sum_3);
+        __m256d low = _mm256_permute2f128_pd(pair_01, pair_23, 0x20);
+        __m256d high = _mm256_permute2f128_pd(pair_01, pair_23, 0x31);
+        __m256d sum = _mm256_add_pd(low, high);
+
+        // Softsign
+        sum = _mm256_div_pd(sum, _mm256_add_pd(one, _mm256_andnot_pd(sign_mask, sum)));
+        _mm256_storeu_pd(output + j, sum);
+    }
+
+    // Remaining rows
+    for (; j < rows; j++) {
+        const double *row = matrix + j * stride;
+        __m256d sum_vector = _mm256_setzero_pd();
+
+        for (size_t k = 0; k < stride; k += 4) {
+            sum_vector = _mm256_fmadd_pd(_mm256_load_pd(input + k), _mm256_load_pd(row + k), sum_vector);
+        }
+
+        output[j] = activate(reduce_add_avx2(sum_vector));
+    }
+}
+
+// Function to reduce four row sums to one vector, one lane per row, and apply softsign
+__attribute__((target("avx2,fma")))
+static inline __m256d reduce_activate_avx2(const __m256d sum_0, const __m256d sum_1, const __m256d sum_2,
+                                           const __m256d sum_3) {
+    const __m256d sign_mask = _mm256_set1_pd(-0.0);
+    const __m256d one = _mm256_set1_pd(1.0);
+
+    __m256d pair_01 = _mm256_hadd_pd(sum_0, sum_1);
+    __m256d pair_23 = _mm256_hadd_pd(sum_2, sum_3);
+    __m256d sum = _mm256_add_pd(_mm256_permute2f128_pd(pair_01, pair_23, 0x20),
+                                _mm256_permute2f128_pd(pair_01, pair_23, 0x31));
+    return _mm256_div_pd(sum, _mm256_add_pd(one, _mm256_andnot_pd(sign_mask, sum)));
+}
+
+__attribute__((target("avx2,fma")))
+static void layer_batch_avx2(const double *matrix, const double *inputs, double *outputs, const size_t rows,
+                             const size_t stride, const size_t batch, const size_t input_stride,
+                             const size_t output_stride) {
+    size_t j = 0;
+
+    // Register block of four rows by two inputs. Each loaded weight vector is used for both inputs, and each loaded
+    // input vector for all four rows.
+    for (; j + 4 <= rows; j += 4) {
+        const double *row = matrix + j * stride;
+        size_t b = 0;
+
+        for (; b + 2 <= batch; b += 2) {
+            const double *input_0 = inputs + b * input_stride;
+            const double *input_1 = input_0 + input_stride;
+            __m256d sum_00 = _mm256_setzero_pd(), sum_01 = _mm256_setzero_pd();
+            __m256d sum_02 = _mm256_setzero_pd(), sum_03 = _mm256_setzero_pd();
+            __m256d sum_10 = _mm256_setzero_pd(), sum_11 = _mm256_setzero_pd();
+            __m256d sum_12 = _mm256_setzero_pd(), sum_13 = _mm256_setzero_pd();
+
+            for (size_t k = 0; k < stride; k += 4) {
+                __m256d in_0 = _mm256_load_pd(input_0 + k);
+                __m256d in_1 = _mm256_load_pd(input_1 + k);
+                __m256d weight = _mm256_load_pd(row + k);
+                sum_00 = _mm256_fmadd_pd(in_0, weight, sum_00);
+                sum_10 = _mm256_fmadd_pd(in_1, weight, sum_10);
+                weight = _mm256_load_pd(row + stride + k);
+                sum_01 = _mm256_fmadd_pd(in_0, weight, sum_01);
+                sum_11 = _mm256_fmadd_pd(in_1, weight, sum_11);
+                weight = _mm256_load_pd(row + 2 * stride + k);
+                sum_02 = _mm256_fmadd_pd(in_0, weight, sum_02);
+                sum_12 = _mm256_fmadd_pd(in_1, weight, sum_12);
+                weight = _mm256_load_pd(row + 3 * stride + k);
+                sum_03 = _mm256_fmadd_pd(in_0, weight, sum_03);
+                sum_13 = _mm256_fmadd_pd(in_1, weight, sum_13);
+            }
+
+            _mm256_storeu_pd(outputs + b * output_stride + j, reduce_activate_avx2(sum_00, sum_01, sum_02, sum_03));
+            _mm256_storeu_pd(outputs + (b + 1) * output_stride + j,
+                             reduce_activate_avx2(sum_10, sum_11, sum_12, sum_13));
+        }
+
+        // Remaining input
+        for (; b < batch; b++) {
+            const double *input = inputs + b * input_stride;
+            __m256d sum_0 = _mm256_setzero_pd(), sum_1 = _mm256_setzero_pd();
+            __m256d sum_2 = _mm256_setzero_pd(), sum_3 = _mm256_setzero_pd();
+
+            for (size_t k = 0; k < stride; k += 4) {
+                __m256d in = _mm256_load_pd(input + k);
+                sum_0 = _mm256_fmadd_pd(in, _mm256_load_pd(row + k), sum_0);
+                sum_1 = _mm256_fmadd_pd(in, _mm256_load_pd(row + stride + k), sum_1);
+                sum_2 = _mm256_fmadd_pd(in, _mm256_load_pd(row + 2 * stride + k), sum_2);
+                sum_3 = _mm256_fmadd_pd(in, _mm256_load_pd(row + 3 * stride + k), sum_3);
+            }
+
+            _mm256_storeu_pd(outputs + b * output_stride + j, reduce_activate_avx2(sum_0, sum_1, sum_2, sum_3));
+        }
+    }
+
+    // Remaining rows
+    for (; j < rows; j++) {
+        const double *row = matrix + j * stride;
+
+        for (size_t b = 0; b < batch; b++) {
+            const double *input = inputs + b * input_stride;
+            __m256d sum_vector = _mm256_setzero_pd();
+
+            for (size_t k = 0; k < stride; k += 4) {
+                sum_vector = _mm256_fmadd_pd(_mm256_load_pd(input + k), _mm256_load_pd(row + k), sum_vector);
+            }
+
+            __m128d sum = _mm_add_pd(_mm256_castpd256_pd128(sum_vector), _mm256_extractf128_pd(sum_vector, 1));
+            sum = _mm_add_sd(sum, _mm_unpackhi_pd(sum, sum));
+            outputs[b * output_stride + j] = activate(_mm_cvtsd_f64(sum));
+        }
+    }
+}
+
+__attribute__((target("avx2,fma")))
+static void layer_avx2_fp32(const float *matrix, const float *input, float *output, const size_t rows,
+                            const size_t stride) {
+    const __m256 sign_mask = _mm256_set1_ps(-0.0f);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    // Sums for up to 8 rows are gathered here, so they can be activated together
+    alignas(NEURALNET_ALIGNMENT) float sums[8];
+
+    for (size_t j = 0; j < rows; j += 8) {
+        size_t block = (rows - j < 8) ? rows - j : 8;
+
+        for (size_t r = 0; r < block; r++) {
+            const float *row = matrix + (j + r) * stride;
+            __m256 sum_vector = _mm256_setzero_ps();
+
+            for (size_t k = 0; k < stride; k += 8) {
+                sum_vector = _mm256_fmadd_ps(_mm256_load_ps(input + k), _mm256_load_ps(row + k), sum_vector);
+            }
+
+            // Horizontal sum
+            __m128 sum = _mm_add_ps(_mm256_castps256_ps128(sum_vector), _mm256_extractf128_ps(sum_vector, 1));
+            sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+            sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+            sums[r] = _mm_cvtss_f32(sum);
+        }
+
+        // Softsign on the whole block
+        __m256 sum = _mm256_load_ps(sums);
+        sum = _mm256_div_ps(sum, _mm256_add_ps(one, _mm256_andnot_ps(sign_mask, sum)));
+        _mm256_store_ps(sums, sum);
+        std::copy(sums, sums + block, output + j);
+    }
+}
+
+__attribute__((target("avx2,fma")))
+static void layer_avx2_int8(const int8_t *matrix, const float *row_scales, const int8_t *input,
+                            const float input_scale, float *output, const size_t rows, const size_t stride) {
+    for (size_t j = 0; j < rows; j++) {
+        const int8_t *row = matrix + j * stride;
+        __m256i sum_vector = _mm256_setzero_si256();
+        size_t k = 0;
+
+        // Sign extend 16 values at a time to int16, and multiply add pairs into int32
+        for (; k + 16 <= stride; k += 16) {
+            __m256i in = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(input + k)));
+            __m256i weight = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(row + k)));
+            sum_vector = _mm256_add_epi32(sum_vector, _mm256_madd_epi16(in, weight));
+        }
+
+        __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(sum_vector), _mm256_extracti128_si256(sum_vector, 1));
+
+        // stride is a multiple of 8, so there is at most one group of 8 left
+        if (k < stride) {
+            __m128i in = _mm_cvtepi8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(input + k)));
+            __m128i weight = _mm_cvtepi8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(row + k)));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(in, weight));
+        }
+
+        // Horizontal sum
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4e));
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xb1));
+        output[j] = activate_fp32(float(_mm_cvtsi128_si32(sum)) * row_scales[j] * input_scale);
+    }
+}
+
+__attribute__((target("avx512f")))
+static void layer_avx512(const double *matrix, const double *input, double *output, const size_t rows,
+                         const size_t stride) {
+    const __m512d one = _mm512_set1_pd(1.0);
+    // Sums for up to 8 rows are gathered here, so they can be activated together
+    alignas(NEURALNET_ALIGNMENT) double sums[8];
+
+    for (size_t j = 0; j < rows; j += 8) {
+        size_t block = (rows - j < 8) ? rows - j : 8;
+
+        for (size_t r = 0; r < block; r++) {
+            const double *row = matrix + (j + r) * stride;
+            __m512d sum_vector = _mm512_setzero_pd();
+
+            for (size_t k = 0; k < stride; k += 8) {
+                sum_vector = _mm512_fmadd_pd(_mm512_load_pd(input + k), _mm512_load_pd(row + k), sum_vector);
+            }
+            // Add the halves, then sum the four lanes left. The unmasked extracts, used by _mm512_reduce_add_pd,
+            // start from an undefined vector that GCC reports as maybe uninitialized, so zero masked extracts are
+            // used with every lane selected.
+            sums[r] = reduce_add_avx2(_mm256_add_pd(_mm512_maskz_extractf64x4_pd(0xf, sum_vector, 0),
+                                                    _mm512_maskz_extractf64x4_pd(0xf, sum_vector, 1)));
+        }
+
+        // Softsign on the whole block, storing only the rows that exist
+        __mmask8 mask = __mmask8((1u << block) - 1);
+        __m512d sum = _mm512_maskz_load_pd(mask, sums);
+        sum = _mm512_div_pd(sum, _mm512_add_pd(one, _mm512_abs_pd(sum)));
+        _mm512_mask_storeu_pd(output + j, mask, sum);
+    }
+}
+
+#endif  // NEURALNET_X86_KERNELS
+
+const char *get_kernel_name(const NeuralNetKernel kernel) {
+    switch (kernel) {
+        case NeuralNetKernel::sse42:
+            return "sse4.2";
+        case NeuralNetKernel::avx2:
+            return "avx2";
+        case NeuralNetKernel::avx512:
+            return "avx512";
+        default:
+            return "scalar";
+    }
+}
+
+bool check_kernel_supported(const NeuralNetKernel kernel) {
+#ifdef NEURALNET_X86_KERNELS
+    switch (kernel) {
+        case NeuralNetKernel::sse42:
+            return __builtin_cpu_supports("sse4.2");
+        case NeuralNetKernel::avx2:
+            return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+        case NeuralNetKernel::avx512:
+            return __builtin_cpu_supports("avx512f");
+        default:
+            return true;
+    }
+#else
+    return kernel == NeuralNetKernel::scalar;
+#endif
+}
+
+std::vector<NeuralNetKernel> get_supported_kernels() {
+    std::vector<NeuralNetKernel> result;
+    for (NeuralNetKernel kernel : {NeuralNetKernel::scalar, NeuralNetKernel::sse42, NeuralNetKernel::avx2,
+                                   NeuralNetKernel::avx512}) {
+        if (check_kernel_supported(kernel)) {
+            result.push_back(kernel);
+        }
+    }
+    return result;
+}
+
+const NeuralNetLayerFunctions &get_layer_functions(const NeuralNetKernel kernel) {
+    // Layer functions of each kernel. AVX-512 uses the AVX2 batch, fp32 and int8 kernels, as rows are only padded
+    // to 8. SSE4.2 uses the scalar batch kernel.
+    static const NeuralNetLayerFunctions scalar_functions { &layer_scalar, &layer_batch_scalar, &layer_scalar_fp32,
+                                                            &layer_scalar_int8 };
+#ifdef NEURALNET_X86_KERNELS
+    static const NeuralNetLayerFunctions sse42_functions { &layer_sse42, &layer_batch_scalar, &layer_sse42_fp32,
+                                                           &layer_sse42_int8 };
+    static const NeuralNetLayerFunctions avx2_functions { &layer_avx2, &layer_batch_avx2, &layer_avx2_fp32,
+                                                          &layer_avx2_int8 };
+    static const NeuralNetLayerFunctions avx512_functions { &layer_avx512, &layer_batch_avx2, &layer_avx2_fp32,
+                                                            &layer_avx2_int8 };
+#endif
+
+    if (!check_kernel_supported(kernel)) {
+        throw NeuralNetKernelError();
+    }
+
+    switch (kernel) {
+#ifdef NEURALNET_X86_KERNELS
+        case NeuralNetKernel::sse42:
+            return sse42_functions;
+        case NeuralNetKernel::avx2:
+            return avx2_functions;
+        case NeuralNetKernel::avx512:
+            return avx512_functions;
+#endif
+        default:
+            return scalar_functions;
+    }
+}
+
+// Active kernel, selected on first use
+static std::atomic<const NeuralNetLayerFunctions *> active_layer_functions(nullptr);
+static std::atomic<NeuralNetKernel> active_kernel(NeuralNetKernel::scalar);
+
+NeuralNetKernel get_active_kernel() {
+    get_active_layer_functions();
+    return active_kernel;
+}
+
+void set_active_kernel(const NeuralNetKernel kernel) {
+    const NeuralNetLayerFunctions &functions = get_layer_functions(kernel);
+    active_kernel = kernel;
+    active_layer_functions = &functions;
+}
+
+const NeuralNetLayerFunctions &get_active_layer_functions() {
+    const NeuralNetLayerFunctions *functions = active_layer_functions;
+    if (functions == nullptr) {
+        // Select the best supported kernel
+        set_active_kernel(get_supported_kernels().back());
+        functions = active_layer_functions;
+    }
+    return *functions;
+}
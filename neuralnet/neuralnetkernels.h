@@ -0,0 +1,78 @@
+// Copyright [2016] <duncan@wduncanfraser.com>
+// Prototype of the NeuralNet layer kernels, with runtime CPU dispatch
+
+#ifndef NEURALNET_NEURALNETKERNELS_H_
+#define NEURALNET_NEURALNETKERNELS_H_
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+class NeuralNetKernelError : public std::runtime_error {
+ public:
+    NeuralNetKernelError() : std::runtime_error("NeuralNetKernelError") { }
+};
+
+// Instruction sets with a layer kernel, in order of preference
+enum class NeuralNetKernel : uint8_t {
+    scalar,
+    sse42,
+    avx2,
+    avx512
+};
+
+// Layer kernel. For each of rows weight rows of length stride, calculates activate(row . input) into output.
+// stride must be a multiple of NEURALNET_SIMD_WIDTH, and matrix and input must be NEURALNET_ALIGNMENT aligned.
+// Only output[0] to output[rows - 1] are written.
+typedef void (*NeuralNetLayerFunction)(const double *matrix, const double *input, double *output, const size_t rows,
+                                       const size_t stride);
+
+// Batch layer kernel. Calculates the layer for batch inputs at once, as a matrix-matrix multiply, so each weight row
+// is loaded once per batch instead of once per input. Input b starts at inputs + b * input_stride, and its output is
+// written to output[b * output_stride] to output[b * output_stride + rows - 1]. input_stride must keep inputs aligned.
+typedef void (*NeuralNetBatchLayerFunction)(const double *matrix, const double *inputs, double *outputs,
+                                            const size_t rows, const size_t stride, const size_t batch,
+                                            const size_t input_stride, const size_t output_stride);
+
+// Single precision layer kernel. Same layout requirements as NeuralNetLayerFunction.
+typedef void (*NeuralNetLayerFunctionFp32)(const float *matrix, const float *input, float *output, const size_t rows,
+                                           const size_t stride);
+
+// int8 layer kernel. For each row, calculates activate((row . input) * row_scales[row] * input_scale) into output.
+// Sums are accumulated as int32. stride must be a multiple of NEURALNET_SIMD_WIDTH.
+typedef void (*NeuralNetLayerFunctionInt8)(const int8_t *matrix, const float *row_scales, const int8_t *input,
+                                           const float input_scale, float *output, const size_t rows,
+                                           const size_t stride);
+
+// Layer kernels of each precision for one instruction set
+struct NeuralNetLayerFunctions {
+    NeuralNetLayerFunction fp64;
+    NeuralNetBatchLayerFunction fp64_batch;
+    NeuralNetLayerFunctionFp32 fp32;
+    NeuralNetLayerFunctionInt8 int8;
+};
+
+// Function to get the name of a kernel
+const char *get_kernel_name(const NeuralNetKernel kernel);
+
+// Function to check if the CPU supports a kernel. The scalar kernel is always supported.
+bool check_kernel_supported(const NeuralNetKernel kernel);
+
+// Function to get all kernels supported by the CPU, scalar first
+std::vector<NeuralNetKernel> get_supported_kernels();
+
+// Function to get the kernel used by NeuralNet::feed_forward. Defaults to the best supported kernel.
+NeuralNetKernel get_active_kernel();
+
+// Function to set the kernel used by NeuralNet::feed_forward. Throws NeuralNetKernelError if not supported.
+void set_active_kernel(const NeuralNetKernel kernel);
+
+// Function to get the layer functions of a kernel. Throws NeuralNetKernelError if not supported.
+// Precisions without a dedicated implementation for an instruction set use the next best supported one.
+const NeuralNetLayerFunctions &get_layer_functions(const NeuralNetKernel kernel);
+
+// Function to get the layer functions of the active kernel
+const NeuralNetLayerFunctions &get_active_layer_functions();
+
+#endif  // NEURALNET_NEURALNETKERNELS_H_
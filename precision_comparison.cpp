@@ -0,0 +1,112 @@
+// Copyright [2016] <duncan@wduncanfraser.com>
+// Accuracy comparison of the reduced NeuralNet inference precisions against fp64, over a corpus of positions
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cmath>
+
+#include "gogamenn.h"
+
+#define BOARD_SIZE 9;
+#define POSITIONS 1000;
+// Maximum random moves played to reach each position
+#define MAX_MOVES 80
+
+class ComparisonArgumentError : public std::runtime_error {
+ public:
+    ComparisonArgumentError() : std::runtime_error("ComparisonArgumentError") { }
+};
+
+// Struct for holding one position of the corpus
+struct ComparisonPosition {
+    std::vector<std::vector<double>> translation;
+    uint8_t pieces_played;
+    uint8_t prisoner_count;
+    uint8_t opponent_prisoner_count;
+};
+
+int main(int argc, char* argv[]) {
+    uint8_t board_size = 0;
+    uint32_t position_count = 0;
+
+    // Validate command line parameters. An optional weights file is evaluated instead of a random network.
+    if (argc == 1) {
+        // No parameters, use the Macros
+        board_size = BOARD_SIZE;
+        position_count = POSITIONS;
+    } else if (argc == 3 || argc == 4) {
+        // TODO(wdfraser): Add some better error checking
+        board_size = uint8_t(atoi(argv[1]));
+        position_count = atoi(argv[2]);
+    } else {
+        std::cout << "Usage: precision_comparison [board_size positions [weights_file]]\n";
+        throw ComparisonArgumentError();
+    }
+
+    GoGameNN network(board_size, false);
+    if (argc == 4) {
+        std::ifstream file(argv[3]);
+        network.import_weights_stream(file);
+    } else {
+        network.initialize_random();
+    }
+
+    // Build the corpus from random games, from both players' perspective
+    std::mt19937 generator(2016);
+    std::uniform_int_distribution<unsigned int> length_distribution(0, MAX_MOVES);
+    std::vector<ComparisonPosition> corpus;
+    for (uint32_t i = 0; i < position_count; i++) {
+        GoGame game(board_size);
+        bool color = 0;
+        unsigned int length = length_distribution(generator);
+        for (unsigned int j = 0; j < length; j++) {
+            game.generate_moves(color);
+            std::vector<GoMove> move_list = game.get_move_list();
+            std::uniform_int_distribution<size_t> move_distribution(0, move_list.size() - 1);
+            game.make_move(move_list[move_distribution(generator)], color);
+            color = !color;
+        }
+
+        corpus.push_back({get_go_network_translation(game, color), game.get_pieces_placed()[color],
+                          game.get_prisoner_count()[color], game.get_prisoner_count()[!color]});
+    }
+
+    // Reference outputs
+    std::vector<double> reference;
+    for (const ComparisonPosition &position : corpus) {
+        network.feed_forward(position.translation, position.pieces_played, position.prisoner_count,
+                             position.opponent_prisoner_count);
+        reference.push_back(network.get_output());
+    }
+
+    std::cout << "Board size " << int(board_size) << ", " << corpus.size() << " positions\n";
+
+    for (NeuralNetPrecision precision : {NeuralNetPrecision::fp32, NeuralNetPrecision::int8}) {
+        network.set_precision(precision);
+
+        double total_drift = 0;
+        double max_drift = 0;
+        // Count of positions where the output changes sign, which may change move ordering
+        unsigned int sign_changes = 0;
+        for (size_t i = 0; i < corpus.size(); i++) {
+            const ComparisonPosition &position = corpus[i];
+            network.feed_forward(position.translation, position.pieces_played, position.prisoner_count,
+                                 position.opponent_prisoner_count);
+            double output = network.get_output();
+
+            double drift = std::abs(output - reference[i]);
+            total_drift += drift;
+            max_drift = std::max(max_drift, drift);
+            if ((output < 0) != (reference[i] < 0)) {
+                sign_changes++;
+            }
+        }
+
+        std::cout << (precision == NeuralNetPrecision::fp32 ? "fp32" : "int8") << ": mean drift "
+                  << total_drift / corpus.size() << ", max drift " << max_drift << ", sign changes "
+                  << sign_changes << std::endl;
+    }
+}
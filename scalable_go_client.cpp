@@ -1,18 +1,23 @@
 // Copyright [2015, 2016] <duncan@wduncanfraser.com>
 
+#include <algorithm>
 #include <array>
 #include <vector>
 #include <iostream>
 #include <string>
 #include <limits>
 #include <stdexcept>
+#include <thread>
 
 #include "gogame.h"
 #include "gogamenn.h"
-#include "gogameab.h"
+#include "gosearch.h"
 #include "gohelpers.h"
 
-#define DEPTH 1
+// Search depth, counting the move being chosen
+#define DEPTH 2
+// Search time per move in seconds, 0 for no limit. Iterations past the first are abandoned at the limit.
+#define MOVE_TIME 0
 
 class ClientArgumentError : public std::runtime_error {
  public:
@@ -24,7 +29,7 @@ class ClientImportError : public std::runtime_error {
     ClientImportError() : std::runtime_error("ClientImportError") { }
 };
 
-std::array<uint8_t, 2> play_game(GoGameNN &i_network, const uint8_t board_size) {
+std::array<uint8_t, 2> play_game(GoGameNN &i_network, const uint8_t board_size, const unsigned int thread_count) {
     // Array of Vectors to hold win counts for networks
     std::array<uint8_t , 2> scores = {0, 0};
 
@@ -39,31 +44,15 @@ std::array<uint8_t, 2> play_game(GoGameNN &i_network, const uint8_t board_size)
     // Bool to determine if game should continue
     bool continue_match = true;
 
-    // Value of best move
-    double best_move_value, temp_best_move_value = 0;
-
+    // Search driver, keeping its transposition table between moves
+    GoSearch search(i_network, GOTT_DEFAULT_SIZE_MB, thread_count);
 
     while (continue_match) {
         std::cout << "Black taking move... \n";
 
-        // Generate and take black move
-        game.generate_moves(0);
-        best_move_value = -std::numeric_limits<double>::infinity();
-
-        // For each possible move, calculate Alpha Beta
-        for (const GoMove &element : game.get_move_list()) {
-            GoGame temp_game(game);
-            temp_game.make_move(element, 0);
-
-            temp_best_move_value = scalable_go_ab_prune(i_network, temp_game, DEPTH,
-                                                        -std::numeric_limits<double>::infinity(),
-                                                        std::numeric_limits<double>::infinity(), 1, false, 0);
-
-            if (temp_best_move_value > best_move_value) {
-                best_move_value = temp_best_move_value;
-                best_move = element;
-            }
-        }
+        // Search and take black move
+        GoSearchResult result = search.search(game, 0, GoSearchLimits(DEPTH, 0, MOVE_TIME));
+        best_move = result.best_move;
         // Make White move
         game.make_move(best_move, 0);
 
@@ -129,24 +118,29 @@ int main(int argc, char* argv[]) {
     uint8_t board_size = 0;
     std::string network_file_path = "";
     bool network_uniform = 0;
+    // Search threads, all hardware threads unless given
+    unsigned int thread_count = std::max(std::thread::hardware_concurrency(), 1u);
 
     // Validate command line parameters
-    if (argc == 4) {
+    if ((argc == 4) || (argc == 5)) {
         // TODO(wdfraser): Add some better error checking
         board_size = uint8_t(atoi(argv[1]));
         network_file_path = argv[2];
         network_uniform = atoi(argv[3]) != 0;
+        if (argc == 5) {
+            thread_count = unsigned(atoi(argv[4]));
+        }
     } else {
         throw ClientArgumentError();
     }
 
-    GoGameNN client_network(board_size, network_uniform);
-
-    // Import network
-    std::ifstream network_in(network_file_path);
+    // Held in a vector for import_go_networks
+    std::vector<GoGameNN> client_networks(1, GoGameNN(board_size, network_uniform));
+    GoGameNN &client_network = client_networks[0];
 
-    if (network_in.is_open()) {
-        client_network.import_weights_stream(network_in);
+    // Import network, from a binary weight file or text
+    if (std::ifstream(network_file_path).is_open()) {
+        import_go_networks(client_networks, 1, network_file_path);
     } else {
         std::cout << "Network file failed to open. Exiting. \n";
         throw ClientImportError();
@@ -154,7 +148,7 @@ int main(int argc, char* argv[]) {
 
     std::cout << "Game start, Network goes first: " << std::endl;
 
-    std::array<uint8_t, 2> scores = play_game(client_network, board_size);
+    std::array<uint8_t, 2> scores = play_game(client_network, board_size, thread_count);
 
 
     // Who won and score.
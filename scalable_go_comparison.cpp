@@ -33,6 +33,8 @@ std::array<std::vector<int>, 2> compare_sets(std::vector<GoGameNN> i_set1, std::
 
     // Each network plays every network from the opposing set, storing total score for each neural network.
     // Set 1 always plays as black. Set 2 always plays as white.
+    // Both sets are copied per thread, so the set 1 and set 2 networks of a game have neurons no other game writes.
+    // Each copy of a set evaluates with that set's weights in place.
     #pragma omp parallel for firstprivate(i_set1, i_set2) schedule(dynamic, 1)
     for (unsigned int i = 0; i < NETWORKKEEP; i++) {
         for (unsigned int j = 0; j < NETWORKKEEP; j++) {
@@ -57,12 +59,13 @@ std::array<std::vector<int>, 2> compare_sets(std::vector<GoGameNN> i_set1, std::
 
                 // For each possible move, calculate Alpha Beta
                 for (const GoMove &element : training_game.get_move_list()) {
-                    GoGame temp_game(training_game);
-                    temp_game.make_move(element, 0);
+                    // Make the move in place, search, and take it back
+                    training_game.play(element, 0);
 
-                    temp_best_move_value = scalable_go_ab_prune(i_set1[i], temp_game, DEPTH,
-                                                                -std::numeric_limits<double>::infinity(),
-                                                                std::numeric_limits<double>::infinity(), 1, false, 0);
+                    temp_best_move_value = -scalable_go_ab_prune(i_set1[i], training_game, DEPTH,
+                                                                 -std::numeric_limits<double>::infinity(),
+                                                                 std::numeric_limits<double>::infinity(), 1, 0);
+                    training_game.undo();
 
                     if (temp_best_move_value > best_move_value) {
                         best_move_value = temp_best_move_value;
@@ -78,12 +81,13 @@ std::array<std::vector<int>, 2> compare_sets(std::vector<GoGameNN> i_set1, std::
 
                 // For each possible move, calculate Alpha Beta
                 for (const GoMove &element : training_game.get_move_list()) {
-                    GoGame temp_game(training_game);
-                    temp_game.make_move(element, 1);
+                    // Make the move in place, search, and take it back
+                    training_game.play(element, 1);
 
-                    temp_best_move_value = scalable_go_ab_prune(i_set2[j], temp_game, DEPTH,
-                                                                -std::numeric_limits<double>::infinity(),
-                                                                std::numeric_limits<double>::infinity(), 0, false, 1);
+                    temp_best_move_value = -scalable_go_ab_prune(i_set2[j], training_game, DEPTH,
+                                                                 -std::numeric_limits<double>::infinity(),
+                                                                 std::numeric_limits<double>::infinity(), 0, 1);
+                    training_game.undo();
 
                     if (temp_best_move_value > best_move_value) {
                         best_move_value = temp_best_move_value;
@@ -99,12 +103,16 @@ std::array<std::vector<int>, 2> compare_sets(std::vector<GoGameNN> i_set1, std::
                 if (history[history.size() - 1].check_pass() && history[history.size() - 2].check_pass()) {
                     std::array<uint8_t, 2> game_score = training_game.calculate_scores();
 
+                    // scores[0][i] belongs to this thread alone. Every thread plays set 2 network j, so its score is
+                    // updated atomically.
                     if (game_score[0] > game_score[1]) {
                         // Black Wins
                         scores[0][i] += 1;
+                        #pragma omp atomic
                         scores[1][j] -= 1;
                     } else if (game_score[1] > game_score[0]) {
                         // White wins
+                        #pragma omp atomic
                         scores[1][j] += 1;
                         scores[0][i] -= 1;
                     }
@@ -139,25 +147,23 @@ int main(int argc, char* argv[]) {
     std::vector<GoGameNN> set_1_networks(NETWORKKEEP, GoGameNN(board_size, set_1_uniform));
     std::vector<GoGameNN> set_2_networks(NETWORKKEEP, GoGameNN(board_size, set_2_uniform));
 
-    // Import networks
-    std::ifstream set_1_in(set_1_dir + "/lastbestnetworks.txt");
-    std::ifstream set_2_in(set_2_dir + "/lastbestnetworks.txt");
+    // Import networks, from binary weight files (.bin) or text (.txt). Binary is preferred when both exist.
+    std::string set_1_path = get_go_networks_path(set_1_dir + "/lastbestnetworks");
+    std::string set_2_path = get_go_networks_path(set_2_dir + "/lastbestnetworks");
 
     // Import set 1
-    if (set_1_in.is_open()) {
-        for (unsigned int i = 0; i < NETWORKKEEP; i++) {
-            set_1_networks[i].import_weights_stream(set_1_in);
-        }
+    if (std::ifstream(set_1_path).is_open()) {
+        std::cout << "Loading set 1 from " << set_1_path << ".\n";
+        import_go_networks(set_1_networks, NETWORKKEEP, set_1_path);
     } else {
         std::cout << "Set 1 file failed to open. Ending comparison. \n";
         throw ComparisonImportError();
     }
 
     // Import set 2
-    if (set_2_in.is_open()) {
-        for (unsigned int i = 0; i < NETWORKKEEP; i++) {
-            set_2_networks[i].import_weights_stream(set_2_in);
-        }
+    if (std::ifstream(set_2_path).is_open()) {
+        std::cout << "Loading set 2 from " << set_2_path << ".\n";
+        import_go_networks(set_2_networks, NETWORKKEEP, set_2_path);
     } else {
         std::cout << "Set 2 file failed to open. Ending comparison. \n";
         throw ComparisonImportError();
@@ -41,6 +41,8 @@ std::vector<int> score_networks(std::vector<GoGameNN> networks, const uint8_t bo
     std::vector<int> scores(networks.size(), 0);
 
     // Each network plays every other network as each team, storing total score for each neural network.
+    // networks is copied per thread, as networks[i] and networks[j] write their neurons on every evaluation. The
+    // population's weights, and their reduced precision forms, are not duplicated, the copies point at the same ones.
     #pragma omp parallel for firstprivate(networks) schedule(dynamic, 1)
     for (unsigned int i = 0; i < networks.size(); i++) {
         for (unsigned int j = 0; j < networks.size(); j++) {
@@ -63,12 +65,13 @@ std::vector<int> score_networks(std::vector<GoGameNN> networks, const uint8_t bo
 
                 // For each possible move, calculate Alpha Beta
                 for (const GoMove &element : training_game.get_move_list()) {
-                    GoGame temp_game(training_game);
-                    temp_game.make_move(element, 0);
+                    // Make the move in place, search, and take it back
+                    training_game.play(element, 0);
 
-                    temp_best_move_value = scalable_go_ab_prune(networks[i], temp_game, DEPTH,
-                                                                -std::numeric_limits<double>::infinity(),
-                                                                std::numeric_limits<double>::infinity(), 1, false, 0);
+                    temp_best_move_value = -scalable_go_ab_prune(networks[i], training_game, DEPTH,
+                                                                 -std::numeric_limits<double>::infinity(),
+                                                                 std::numeric_limits<double>::infinity(), 1, 0);
+                    training_game.undo();
 
                     if (temp_best_move_value > best_move_value) {
                         best_move_value = temp_best_move_value;
@@ -84,12 +87,13 @@ std::vector<int> score_networks(std::vector<GoGameNN> networks, const uint8_t bo
 
                 // For each possible move, calculate Alpha Beta
                 for (const GoMove &element : training_game.get_move_list()) {
-                    GoGame temp_game(training_game);
-                    temp_game.make_move(element, 1);
+                    // Make the move in place, search, and take it back
+                    training_game.play(element, 1);
 
-                    temp_best_move_value = scalable_go_ab_prune(networks[j], temp_game, DEPTH,
-                                                                -std::numeric_limits<double>::infinity(),
-                                                                std::numeric_limits<double>::infinity(), 0, false, 1);
+                    temp_best_move_value = -scalable_go_ab_prune(networks[j], training_game, DEPTH,
+                                                                 -std::numeric_limits<double>::infinity(),
+                                                                 std::numeric_limits<double>::infinity(), 0, 1);
+                    training_game.undo();
 
                     if (temp_best_move_value > best_move_value) {
                         best_move_value = temp_best_move_value;
@@ -105,13 +109,18 @@ std::vector<int> score_networks(std::vector<GoGameNN> networks, const uint8_t bo
                 if (history[history.size() - 1].check_pass() && history[history.size() - 2].check_pass()) {
                     std::array<uint8_t, 2> game_score = training_game.calculate_scores();
 
+                    // The thread for row j scores j too, when j plays black, so both updates are atomic
                     if (game_score[0] > game_score[1]) {
                         // Black Wins
+                        #pragma omp atomic
                         scores[i] += 1;
+                        #pragma omp atomic
                         scores[j] -= 1;
                     } else if (game_score[1] > game_score[0]) {
                         // White wins
+                        #pragma omp atomic
                         scores[j] += 1;
+                        #pragma omp atomic
                         scores[i] -= 1;
                     }
                     // Else, draw... assign no scores.
@@ -173,32 +182,31 @@ int main(int argc, char* argv[]) {
         std::string output_directory =
                 "size" + std::to_string(board_size) + "set" + std::to_string(training_set) + "/";
 
-        std::ifstream best_networks_in(output_directory + "lastbestnetworks.txt");
-        std::ifstream import_networks(output_directory + "import_networks.txt");
+        // Network files may be binary weight files (.bin) or text (.txt). Binary is preferred when both exist.
+        std::string best_networks_path = get_go_networks_path(output_directory + "lastbestnetworks");
+        std::string import_networks_path = get_go_networks_path(output_directory + "import_networks");
 
         if (scaled) {
             // If scaled network, confirm import_networks is open
-            if (!import_networks.is_open()) {
+            if (!std::ifstream(import_networks_path).is_open()) {
                 throw TrainingImportError();
             } else {
                 scaling_networks.assign(NETWORKKEEP, GoGameNN(board_size - SEGMENT_DIVISION, uniform));
                 // If it is, import example_networks;
-                for (unsigned int i = 0; i < NETWORKKEEP; i++) {
-                    scaling_networks[i].import_weights_stream(import_networks);
-                }
+                std::cout << "Loading scaling networks from " << import_networks_path << ".\n";
+                import_go_networks(scaling_networks, NETWORKKEEP, import_networks_path);
             }
         }
 
         std::cout << "Generation with " << NETWORKCOUNT << " Neural Networks.\n"
         << "Total Games: " << NETWORKCOUNT * NETWORKCOUNT << std::endl;
 
-        if (best_networks_in.is_open()) {
-            std::cout << "Starting generation " << n << ". Last best network file succesfully opened. \n";
+        if (std::ifstream(best_networks_path).is_open()) {
+            std::cout << "Starting generation " << n << ". Last best network file succesfully opened. \n"
+            << "Loading networks from " << best_networks_path << ".\n";
 
             // Read kept networks from file
-            for (unsigned int i = 0; i < NETWORKKEEP; i++) {
-                training_networks[i].import_weights_stream(best_networks_in);
-            }
+            import_go_networks(training_networks, NETWORKKEEP, best_networks_path);
             for (unsigned int i = 0; i < NETWORKKEEP; i++) {
                 training_networks[i + NETWORKKEEP] = training_networks[i];
                 training_networks[i + NETWORKKEEP].mutate(MUTATER);
@@ -254,6 +262,10 @@ int main(int argc, char* argv[]) {
         }
 
         if (best_networks_file.is_open()) {
+            // Best networks are also written in the binary format, which loads without parsing. The writer is only
+            // created once the text files are open, so an error leaves no partial binary file behind.
+            NeuralNetWeightFileWriter best_networks_binary(output_directory + "lastbestnetworks.bin");
+
             // Check down to lowest possible score, -NETWORKCOUNT*2
             for (int i = NETWORKCOUNT - 1; i > -NETWORKCOUNT * 2; i--) {
                 if (export_count >= NETWORKKEEP) {
@@ -265,11 +277,13 @@ int main(int argc, char* argv[]) {
                     }
                     if (training_scores[j] == i) {
                         training_networks[j].export_weights_stream(best_networks_file);
+                        training_networks[j].export_weights_binary(best_networks_binary);
                         export_count += 1;
                     }
                 }
             }
             best_networks_file.close();
+            best_networks_binary.close();
         } else {
             std::cout << "Error opening best networks file. \n";
             break;
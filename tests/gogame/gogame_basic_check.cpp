@@ -6,6 +6,7 @@
 #include "gtest/gtest.h"
 
 #include "gogame.h"
+#include "gogamet.h"
 
 TEST(gogame_basic_check, mask_black_check) {
     // Validates that the right mask is given for black
@@ -102,3 +103,63 @@ TEST(gogame_basic_check, first_move_generation) {
 
     EXPECT_EQ(test_move_list, test.get_move_list());
 }
+
+TEST(gogame_basic_check, board_vector_round_trip) {
+    // Validate that a board assigned from nested vectors converts back to the same vectors
+    std::vector<std::vector<uint8_t>> input_board { {get_mask(0), 0, get_mask(1)},
+                                                    {0, get_mask(1), 0},
+                                                    {get_mask(1), 0, get_mask(0)} };
+    GoBoard test_board(input_board);
+    std::vector<std::vector<uint8_t>> output_board = test_board.board;
+
+    EXPECT_EQ(input_board, output_board);
+    EXPECT_EQ(get_mask(1), test_board.board[1][1]);
+    EXPECT_EQ(get_mask(0), test_board.board.get(2, 2));
+}
+
+TEST(gogame_basic_check, board_bad_mask) {
+    // Validate that assigning an unknown mask to a point throws
+    GoBoard test_board(5);
+    EXPECT_THROW(test_board.board[0][0] = SCORED_MASK, GoBoardBadMask);
+}
+
+TEST(gogame_basic_check, board_copy_compare_19x19) {
+    // Validate that copies of a populated 19x19 board compare equal, and differ after a change
+    GoBoard test1(19);
+    test1.board[18][18] = get_mask(0);
+    test1.board[0][18] = get_mask(1);
+    test1.board[9][4] = get_mask(0);
+
+    GoBoard test2(test1);
+    EXPECT_EQ(test1, test2);
+
+    test2.board[9][4] = get_mask(1);
+    EXPECT_FALSE(test1 == test2);
+}
+
+TEST(gogame_basic_check, kernel_adjacent_all_sizes) {
+    // Validate the size specialized kernels against get_adjacent for every point on every board size
+    for (uint8_t board_size = 3; board_size <= 19; board_size++) {
+        const GoKernels &kernels = get_go_kernels(board_size);
+        EXPECT_EQ(board_size, kernels.board_size);
+
+        for (uint8_t y = 0; y < board_size; y++) {
+            for (uint8_t x = 0; x < board_size; x++) {
+                GoBitSet point;
+                point.set(uint16_t(y * board_size + x));
+
+                GoBitSet expected;
+                for (const XYCoordinate &element : get_adjacent(XYCoordinate(x, y), board_size)) {
+                    expected.set(uint16_t(element.y * board_size + element.x));
+                }
+                ASSERT_EQ(expected, kernels.adjacent_set(point));
+            }
+        }
+
+        // Flooding an empty board from a single point reaches every point
+        GoBitSet seed;
+        seed.set(0);
+        GoBitSet empty = kernels.empty_set(GoBitSet(), GoBitSet());
+        EXPECT_EQ(board_size * board_size, kernels.flood_fill(seed, empty).count());
+    }
+}
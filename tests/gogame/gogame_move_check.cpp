@@ -1,8 +1,10 @@
 // Copyright [2016] <duncan@wduncanfraser.com>
 
+#include <algorithm>
 #include <vector>
 #include <array>
 #include <cstdint>
+#include <random>
 #include "gtest/gtest.h"
 
 #include "gogame.h"
@@ -149,3 +151,293 @@ TEST(gogame_move_check, simple_game_1) {
 
     EXPECT_EQ(expected, test.get_board());
 }
+
+TEST(gogame_move_check, hash_matches_board) {
+    // Validate that the same board reached by different move orders has the same hash
+    uint8_t board_size = 5;
+    GoBoard test_board1(board_size);
+    test_board1.board[1][1] = get_mask(0);
+    test_board1.board[3][2] = get_mask(1);
+
+    GoBoard test_board2(board_size);
+    test_board2.board[3][2] = get_mask(1);
+    test_board2.board[0][0] = get_mask(0);
+    test_board2.board[1][1] = get_mask(0);
+    test_board2.board[0][0] = 0;
+
+    EXPECT_EQ(test_board1.board.get_hash(), test_board2.board.get_hash());
+    EXPECT_NE(GoBoard(board_size).board.get_hash(), test_board1.board.get_hash());
+
+    // Check the incremental hash of a move matches a board built directly
+    GoMove test_move(GoBoard(board_size), XYCoordinate(1, 1));
+    test_move.check_move(0);
+    GoBoard expected_board(board_size);
+    expected_board.board[1][1] = get_mask(0);
+
+    EXPECT_EQ(expected_board.board.get_hash(), test_move.get_board().board.get_hash());
+}
+
+TEST(gogame_move_check, repeate_moves_history_verified) {
+    uint8_t board_size = 5;
+    GoBoard test_board(board_size);
+
+    test_board.board[1] = {0, get_mask(0), 0, get_mask(0), 0};
+    test_board.board[2] = {0, get_mask(1), get_mask(0), get_mask(1), 0};
+    test_board.board[3][2] = get_mask(1);
+
+    GoGame test_game(test_board);
+    test_game.set_history_verification(true);
+
+    // Make first move
+    GoMove test_move1(test_game.get_board(), XYCoordinate(0, 2));
+    test_move1.check_move(0);
+    test_game.make_move(test_move1, 0);
+
+    // Make capture
+    GoMove test_move2(test_game.get_board(), XYCoordinate(2, 1));
+    test_move2.check_move(1);
+    test_game.make_move(test_move2, 1);
+
+    // Attempt to make second capture which would reset board to a prior state
+    GoMove test_move3(test_game.get_board(), XYCoordinate(2, 2));
+    test_move3.check_move(0);
+
+    // Check move is in move history, and a new move is not
+    GoMove test_move4(test_game.get_board(), XYCoordinate(4, 4));
+    test_move4.check_move(0);
+
+    EXPECT_EQ(true, test_game.check_move_history(test_move3));
+    EXPECT_EQ(false, test_game.check_move_history(test_move4));
+}
+
+TEST(gogame_move_check, play_undo_capture) {
+    uint8_t board_size = 5;
+    GoBoard test_board(board_size);
+
+    test_board.board[1] = {0, get_mask(0), 0, get_mask(0), 0};
+    test_board.board[2] = {0, get_mask(1), get_mask(0), get_mask(1), 0};
+    test_board.board[3][2] = get_mask(1);
+
+    GoGame test_game(test_board);
+    GoGame original_game(test_game);
+
+    // Play a move, then a capture
+    GoMove test_move1(test_game.get_board(), XYCoordinate(0, 2));
+    test_move1.check_move(0);
+    test_game.play(test_move1, 0);
+
+    GoMove test_move2(test_game.get_board(), XYCoordinate(2, 1));
+    test_move2.check_move(1);
+    test_game.play(test_move2, 1);
+
+    EXPECT_EQ(test_move2.get_board(), test_game.get_board());
+    EXPECT_EQ(1, test_game.get_prisoner_count()[1]);
+
+    // Take back both moves
+    test_game.undo();
+    EXPECT_EQ(test_move1.get_board(), test_game.get_board());
+
+    test_game.undo();
+    EXPECT_EQ(original_game, test_game);
+    EXPECT_EQ(original_game.get_hash(), test_game.get_hash());
+    EXPECT_EQ(false, test_game.check_move_history(test_move2));
+}
+
+TEST(gogame_move_check, play_undo_pass) {
+    uint8_t board_size = 3;
+    GoGame test_game(board_size);
+    GoGame original_game(test_game);
+
+    test_game.play(GoMove(test_game.get_board()), 0);
+    test_game.play(GoMove(test_game.get_board()), 1);
+    test_game.undo();
+    test_game.undo();
+
+    EXPECT_EQ(original_game, test_game);
+    EXPECT_THROW(test_game.undo(), GoBoardBadUndo);
+}
+
+TEST(gogame_move_check, random_games_match_check_move) {
+    // Play random games, validating the generated move list against GoMove::check_move on every point,
+    // then take back every move and validate the starting state is restored.
+    std::mt19937 generator(12345);
+
+    for (uint8_t board_size : {3, 5, 7}) {
+        for (unsigned int game = 0; game < 4; game++) {
+            GoGame test_game(board_size);
+            GoGame original_game(test_game);
+            bool color = 0;
+            unsigned int moves_made = 0;
+
+            for (unsigned int turn = 0; turn < 60; turn++) {
+                test_game.generate_moves(color);
+
+                // Build the expected move list by checking every point
+                std::vector<GoMove> expected_moves;
+                for (uint8_t y = 0; y < board_size; y++) {
+                    for (uint8_t x = 0; x < board_size; x++) {
+                        if (test_game.get_board().board.get(x, y) != 0) {
+                            continue;
+                        }
+                        GoMove temp_move(test_game.get_board(), XYCoordinate(x, y));
+                        if (temp_move.check_move(color) == 0 || test_game.check_move_history(temp_move)) {
+                            continue;
+                        }
+                        expected_moves.push_back(temp_move);
+                    }
+                }
+                expected_moves.push_back(GoMove(test_game.get_board()));
+
+                std::vector<GoMove> move_list = test_game.get_move_list();
+                ASSERT_EQ(expected_moves, move_list);
+
+                // Prefer stones over passes, so games get crowded
+                std::uniform_int_distribution<size_t> distribution(0, move_list.size() - 1);
+                size_t choice = move_list.size() > 1 ? distribution(generator) % (move_list.size() - 1) : 0;
+                test_game.play(move_list[choice], color);
+                moves_made += 1;
+                color = !color;
+            }
+
+            for (unsigned int i = 0; i < moves_made; i++) {
+                test_game.undo();
+            }
+            EXPECT_EQ(original_game, test_game);
+        }
+    }
+}
+
+TEST(gogame_move_check, generated_move_board) {
+    // Generated moves build their board on request. Validate the board and hash match a checked move.
+    GoGame test_game(5);
+    GoBoard test_board(5);
+    test_board.board[0] = {0, 1, 0, 0, 0};
+    test_board.board[1] = {1, 3, 0, 0, 0};
+    test_board.board[2] = {0, 1, 0, 0, 0};
+    test_game.set_board(test_board);
+
+    GoMove check_move(test_game.get_board(), XYCoordinate(2, 1));
+    EXPECT_EQ(4, check_move.check_move(0));
+    EXPECT_EQ(1, check_move.get_prisoners_captured());
+
+    test_game.generate_moves(0);
+    std::vector<GoMove> move_list = test_game.get_move_list();
+    auto generated = std::find(move_list.begin(), move_list.end(), check_move);
+    ASSERT_NE(move_list.end(), generated);
+
+    GoBoard result_board = generated->get_board();
+    EXPECT_EQ(check_move.get_board(), result_board);
+    EXPECT_EQ(result_board.board.get_hash(), generated->get_hash());
+    EXPECT_EQ(0, result_board.board[1][1]);
+}
+
+TEST(gogame_move_check, random_games_legal_points) {
+    // Play random games with history verification, validating the legal point mask against GoMove::check_move
+    std::mt19937 generator(54321);
+
+    for (uint8_t board_size : {3, 4, 5}) {
+        for (unsigned int game = 0; game < 4; game++) {
+            GoGame test_game(board_size);
+            test_game.set_history_verification(true);
+            bool color = 0;
+
+            for (unsigned int turn = 0; turn < 60; turn++) {
+                GoBitSet legal_points = test_game.generate_legal_points(color);
+
+                for (uint8_t y = 0; y < board_size; y++) {
+                    for (uint8_t x = 0; x < board_size; x++) {
+                        GoMove temp_move(test_game.get_board(), XYCoordinate(x, y));
+                        bool expected = (temp_move.check_move(color) > 0) && !test_game.check_move_history(temp_move);
+                        ASSERT_EQ(expected, legal_points.test(uint16_t(y * board_size + x)));
+                    }
+                }
+
+                test_game.generate_moves(color);
+                std::vector<GoMove> move_list = test_game.get_move_list();
+                ASSERT_EQ(size_t(legal_points.count() + 1), move_list.size());
+
+                // Prefer stones over passes, so games get crowded
+                std::uniform_int_distribution<size_t> distribution(0, move_list.size() - 1);
+                size_t choice = move_list.size() > 1 ? distribution(generator) % (move_list.size() - 1) : 0;
+                test_game.play(move_list[choice], color);
+                color = !color;
+            }
+        }
+    }
+}
+
+TEST(gogame_move_check, suicide_allowed_play_undo) {
+    GoBoard test_board(5);
+    test_board.board[0] = {get_mask(0), 0, get_mask(1), 0, 0};
+    test_board.board[1] = {get_mask(1), get_mask(1), 0, 0, 0};
+
+    GoGame test_game(test_board, GoRules(GoScoring::area, 0.0, GoSuperko::positional, true));
+    GoGame original_game(test_game);
+
+    // Black at (1, 0) joins the black stone in the corner with no liberty, a 2 stone suicide
+    test_game.generate_moves(0);
+    EXPECT_TRUE(test_game.generate_legal_points(0).test(1));
+    GoMove suicide_move(test_game.get_board(), XYCoordinate(1, 0));
+    EXPECT_EQ(0, suicide_move.check_move(0));
+    test_game.make_move(suicide_move, 0);
+
+    EXPECT_EQ(0, test_game.get_board().board[0][0]);
+    EXPECT_EQ(0, test_game.get_board().board[0][1]);
+    EXPECT_EQ(2, test_game.get_prisoner_count()[1]);
+    EXPECT_EQ(suicide_move.get_hash(), test_game.get_hash());
+
+    test_game.undo();
+    EXPECT_EQ(original_game, test_game);
+
+    // Suicide of a single stone leaves the board unchanged, so it is never legal
+    GoBoard single_board(5);
+    single_board.board[0] = {0, get_mask(1), 0, 0, 0};
+    single_board.board[1] = {get_mask(1), 0, 0, 0, 0};
+    GoGame single_game(single_board, GoRules(GoScoring::area, 0.0, GoSuperko::positional, true));
+    EXPECT_FALSE(single_game.generate_legal_points(0).test(0));
+}
+
+TEST(gogame_move_check, random_games_rule_sets) {
+    // Play random games under each rule set, validating the legal points against GoMove::check_move,
+    // then take back every move and validate the starting state is restored.
+    std::mt19937 generator(2718);
+
+    for (bool suicide_allowed : {false, true}) {
+        for (GoSuperko superko : {GoSuperko::positional, GoSuperko::situational}) {
+            for (bool verification : {false, true}) {
+                GoRules rules(GoScoring::area, 7.5, superko, suicide_allowed);
+                GoGame test_game(4, rules);
+                test_game.set_history_verification(verification);
+                GoGame original_game(test_game);
+                bool color = 0;
+
+                for (unsigned int turn = 0; turn < 80; turn++) {
+                    GoBitSet legal_points = test_game.generate_legal_points(color);
+                    GoBoard current_board = test_game.get_board();
+
+                    for (uint8_t y = 0; y < 4; y++) {
+                        for (uint8_t x = 0; x < 4; x++) {
+                            GoMove temp_move(current_board, XYCoordinate(x, y));
+                            int liberty = temp_move.check_move(color);
+                            bool expected = (liberty > 0) ||
+                                    ((liberty == 0) && suicide_allowed && !(temp_move.get_board() == current_board));
+                            expected = expected && !test_game.check_move_history(temp_move);
+                            ASSERT_EQ(expected, legal_points.test(uint16_t(y * 4 + x)));
+                        }
+                    }
+
+                    test_game.generate_moves(color);
+                    std::vector<GoMove> move_list = test_game.get_move_list();
+                    std::uniform_int_distribution<size_t> distribution(0, move_list.size() - 1);
+                    test_game.play(move_list[distribution(generator)], color);
+                    color = !color;
+                }
+
+                for (unsigned int turn = 0; turn < 80; turn++) {
+                    test_game.undo();
+                }
+                EXPECT_EQ(original_game, test_game);
+            }
+        }
+    }
+}
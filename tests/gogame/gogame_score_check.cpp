@@ -3,6 +3,7 @@
 #include <vector>
 #include <array>
 #include <cstdint>
+#include <random>
 #include "gtest/gtest.h"
 
 #include "gogame.h"
@@ -276,3 +277,93 @@ TEST(gogame_score_check, simple_game_3) {
     EXPECT_EQ(expected, test.calculate_scores());
     EXPECT_EQ(expected_pieces, test.get_pieces_placed());
 }
+
+TEST(gogame_score_check, ownership_split_board) {
+    uint8_t board_size = 3;
+    GoBoard test_board(board_size);
+
+    test_board.board[0] = {0, get_mask(1), 0};
+    test_board.board[1] = {get_mask(0), get_mask(0), get_mask(0)};
+
+    GoGame test(test_board);
+    std::array<GoBitSet, 2> ownership = test.calculate_ownership();
+
+    // Bottom row is black territory, the top left and right points border both colors
+    GoBitSet expected_black;
+    expected_black.set(6);
+    expected_black.set(7);
+    expected_black.set(8);
+    EXPECT_EQ(expected_black, ownership[0]);
+    EXPECT_FALSE(ownership[1].any());
+}
+
+TEST(gogame_score_check, random_games_match_territory_string) {
+    // Play random games, validating ownership against construct_territory_string for every empty point
+    std::mt19937 generator(20160);
+
+    for (uint8_t board_size : {5, 9, 19}) {
+        GoGame test_game(board_size);
+        bool color = 0;
+
+        for (unsigned int turn = 0; turn < 120; turn++) {
+            test_game.generate_moves(color);
+            std::vector<GoMove> move_list = test_game.get_move_list();
+            std::uniform_int_distribution<size_t> distribution(0, move_list.size() - 1);
+            test_game.play(move_list[distribution(generator)], color);
+            color = !color;
+
+            if (turn % 10 != 9) {
+                continue;
+            }
+
+            std::array<GoBitSet, 2> ownership = test_game.calculate_ownership();
+            for (uint8_t y = 0; y < board_size; y++) {
+                for (uint8_t x = 0; x < board_size; x++) {
+                    uint8_t expected_owner = 0;
+                    if (test_game.get_board().board.get(x, y) == 0) {
+                        GoString territory_string(board_size);
+                        territory_string.append_member(XYCoordinate(x, y));
+                        expected_owner = test_game.construct_territory_string(territory_string).get_border();
+                    }
+                    uint16_t index = uint16_t(y * board_size + x);
+                    ASSERT_EQ(expected_owner == get_mask(0), ownership[0].test(index));
+                    ASSERT_EQ(expected_owner == get_mask(1), ownership[1].test(index));
+                }
+            }
+        }
+    }
+}
+
+TEST(gogame_score_check, rule_scores_territory_komi) {
+    uint8_t board_size = 3;
+    GoBoard test_board(board_size);
+
+    test_board.board[0] = {get_mask(1), get_mask(1), 0};
+    test_board.board[1] = {get_mask(0), get_mask(0), get_mask(0)};
+
+    GoGame test(test_board, GoRules(GoScoring::territory, 6.5, GoSuperko::positional, false));
+
+    std::array<double, 2> expected { {3.0, 6.5} };
+
+    EXPECT_EQ(expected, test.calculate_rule_scores());
+}
+
+TEST(gogame_score_check, rule_scores_area) {
+    uint8_t board_size = 3;
+    GoBoard test_board(board_size);
+
+    test_board.board[0] = {get_mask(1), get_mask(1), 0};
+    test_board.board[1] = {get_mask(0), get_mask(0), get_mask(0)};
+
+    GoGame test(test_board, GoRules(GoScoring::area, 0.5, GoSuperko::positional, false));
+
+    // Passing adds a prisoner, which does not count under area scoring
+    GoMove pass_move(test.get_board());
+    test.make_move(pass_move, 0);
+
+    std::array<double, 2> expected { {6.0, 2.5} };
+    std::array<uint8_t, 2> expected_territory { {3, 1} };
+
+    EXPECT_EQ(expected, test.calculate_rule_scores());
+    EXPECT_EQ(expected_territory, test.calculate_scores());
+}
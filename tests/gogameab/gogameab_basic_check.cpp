@@ -5,12 +5,50 @@
 #include <iostream>
 #include <string>
 #include <limits>
+#include <algorithm>
+#include <array>
 #include "gtest/gtest.h"
 
 #include "gogame.h"
 #include "gogamenn.h"
 #include "gogameab.h"
 
+// Function to search i_gogame with the minimax alpha beta search scalable_go_ab_prune used before it became a negamax
+// search. Returns the value for player_color.
+static double minimax_ab_prune(GoGameNN &network, GoGame &i_gogame, const int depth, double alpha, double beta,
+                               const bool move_color, const bool max_player, const bool player_color) {
+    i_gogame.generate_moves(move_color);
+    std::vector<GoMove> current_move_list = i_gogame.get_move_list();
+    if ((depth <= 0) || (current_move_list.size() <= 0)) {
+        network.feed_forward(i_gogame, player_color);
+        return network.get_output();
+    }
+
+    for (const GoMove &element : current_move_list) {
+        i_gogame.play(element, move_color);
+        double value = minimax_ab_prune(network, i_gogame, depth - 1, alpha, beta, !move_color, !max_player,
+                                        player_color);
+        i_gogame.undo();
+        if (max_player) {
+            alpha = std::max(alpha, value);
+        } else {
+            beta = std::min(beta, value);
+        }
+        if (beta <= alpha) {
+            break;
+        }
+    }
+    return max_player ? alpha : beta;
+}
+
+// Function to keep the first move with the highest value
+static void update_best_move(const double value, const size_t index, double &best_value, size_t &best_index) {
+    if (value > best_value) {
+        best_value = value;
+        best_index = index;
+    }
+}
+
 TEST(gogameab_basic_check, simple_ab) {
     uint8_t board_size = 5;
     int depth = 1;
@@ -30,9 +68,9 @@ TEST(gogameab_basic_check, simple_ab) {
         GoGame temp_game(test_game);
         temp_game.make_move(element, 0);
 
-        temp_best_move_value = scalable_go_ab_prune(test_network, temp_game, depth,
-                                                    -std::numeric_limits<double>::infinity(),
-                                                    std::numeric_limits<double>::infinity(), 1, false, 0);
+        temp_best_move_value = -scalable_go_ab_prune(test_network, temp_game, depth,
+                                                     -std::numeric_limits<double>::infinity(),
+                                                     std::numeric_limits<double>::infinity(), 1, 0);
 
         if (temp_best_move_value > best_move_value) {
             best_move_value = temp_best_move_value;
@@ -62,9 +100,9 @@ TEST(gogameab_basic_check, simple_ab_uniform) {
         GoGame temp_game(test_game);
         temp_game.make_move(element, 0);
 
-        temp_best_move_value = scalable_go_ab_prune(test_network, temp_game, depth,
-                                                    -std::numeric_limits<double>::infinity(),
-                                                    std::numeric_limits<double>::infinity(), 1, false, 0);
+        temp_best_move_value = -scalable_go_ab_prune(test_network, temp_game, depth,
+                                                     -std::numeric_limits<double>::infinity(),
+                                                     std::numeric_limits<double>::infinity(), 1, 0);
 
         if (temp_best_move_value > best_move_value) {
             best_move_value = temp_best_move_value;
@@ -75,4 +113,113 @@ TEST(gogameab_basic_check, simple_ab_uniform) {
     EXPECT_NO_THROW(test_game.make_move(best_move, 0));
 }
 
+TEST(gogameab_basic_check, ab_restores_game) {
+    // Validate the search leaves the game in its original state
+    uint8_t board_size = 5;
+    int depth = 2;
+    GoGame test_game(board_size);
+    GoGameNN test_network(board_size, false);
+    test_network.initialize_random();
+
+    GoGame original_game(test_game);
+
+    scalable_go_ab_prune(test_network, test_game, depth, -std::numeric_limits<double>::infinity(),
+                         std::numeric_limits<double>::infinity(), 0, 0);
+
+    EXPECT_EQ(original_game, test_game);
+}
+
+TEST(gogameab_basic_check, ab_batched_leaves) {
+    // Validate a depth 1 search, which evaluates its leaves as a batch, matches the minimum over single evaluations
+    uint8_t board_size = 5;
+    GoGame test_game(board_size);
+    GoGameNN test_network(board_size, false);
+    test_network.initialize_random();
 
+    test_game.generate_moves(0);
+    test_game.make_move(test_game.get_move_list()[7], 0);
+
+    double expected = std::numeric_limits<double>::infinity();
+    test_game.generate_moves(1);
+    for (const GoMove &element : test_game.get_move_list()) {
+        test_game.play(element, 1);
+        test_network.feed_forward(get_go_network_translation(test_game, 0), test_game.get_pieces_placed()[0],
+                                  test_game.get_prisoner_count()[0], test_game.get_prisoner_count()[1]);
+        expected = std::min(expected, test_network.get_output());
+        test_game.undo();
+    }
+
+    EXPECT_NEAR(expected, -scalable_go_ab_prune(test_network, test_game, 1, -std::numeric_limits<double>::infinity(),
+                                                std::numeric_limits<double>::infinity(), 1, 0), 1e-12);
+}
+
+TEST(gogameab_basic_check, ab_evaluator_matches) {
+    // Validate the incremental evaluator search matches the full evaluation search
+    uint8_t board_size = 5;
+    int depth = 2;
+    GoGame test_game(board_size);
+    GoGameNN test_network(board_size, false);
+    test_network.initialize_random();
+
+    test_game.generate_moves(0);
+    test_game.make_move(test_game.get_move_list()[7], 0);
+
+    double expected = -scalable_go_ab_prune(test_network, test_game, depth, -std::numeric_limits<double>::infinity(),
+                                            std::numeric_limits<double>::infinity(), 1, 0);
+
+    GoGameNNEvaluator evaluator(test_network, test_game, 0);
+    EXPECT_NEAR(expected, -scalable_go_ab_prune(evaluator, test_game, depth, -std::numeric_limits<double>::infinity(),
+                                                std::numeric_limits<double>::infinity(), 1), 1e-12);
+}
+
+TEST(gogameab_basic_check, negamax_matches_minimax) {
+    // Validate the negamax searches pick the same move, with the same value, as the minimax search over a set of
+    // positions
+    const double infinity = std::numeric_limits<double>::infinity();
+    GoGameNN test_network(5, false);
+    test_network.initialize_random();
+
+    for (unsigned int seed = 0; seed < 4; seed++) {
+        GoGame test_game(5);
+        bool color = 0;
+        for (unsigned int i = 0; i < 2 + seed; i++) {
+            test_game.generate_moves(color);
+            std::vector<GoMove> move_list = test_game.get_move_list();
+            test_game.make_move(move_list[(i * 5 + seed * 13) % (move_list.size() - 1)], color);
+            color = !color;
+        }
+        GoGame original_game(test_game);
+
+        for (int depth = 1; depth <= 3; depth++) {
+            GoTranspositionTable table(1);
+            GoGameNNEvaluator evaluator(test_network, test_game, color);
+            std::array<double, 4> best_values;
+            best_values.fill(-infinity);
+            std::array<size_t, 4> best_indexes;
+            best_indexes.fill(0);
+
+            test_game.generate_moves(color);
+            std::vector<GoMove> move_list = test_game.get_move_list();
+            for (size_t i = 0; i < move_list.size(); i++) {
+                test_game.play(move_list[i], color);
+                update_best_move(minimax_ab_prune(test_network, test_game, depth - 1, -infinity, infinity, !color,
+                                                  false, color), i, best_values[0], best_indexes[0]);
+                update_best_move(-scalable_go_ab_prune(test_network, test_game, depth - 1, -infinity, infinity,
+                                                       !color, color), i, best_values[1], best_indexes[1]);
+                update_best_move(-scalable_go_ab_prune(test_network, test_game, depth - 1, -infinity, infinity,
+                                                       !color, color, table), i, best_values[2], best_indexes[2]);
+                evaluator.update();
+                update_best_move(-scalable_go_ab_prune(evaluator, test_game, depth - 1, -infinity, infinity, !color),
+                                 i, best_values[3], best_indexes[3]);
+                evaluator.rollback();
+                test_game.undo();
+            }
+
+            for (size_t search = 1; search < best_values.size(); search++) {
+                EXPECT_EQ(best_indexes[0], best_indexes[search]);
+                EXPECT_NEAR(best_values[0], best_values[search], 1e-12);
+            }
+            EXPECT_EQ(original_game, test_game);
+        }
+    }
+}
@@ -0,0 +1,189 @@
+// Copyright [2016] <duncan@wduncanfraser.com>
+
+#include <vector>
+#include <cstdint>
+#include <limits>
+#include "gtest/gtest.h"
+
+#include "gogame.h"
+#include "gogamenn.h"
+#include "gogameab.h"
+#include "gosearch.h"
+
+// Function to get the value of the best move of color, searching each move to depth - 1 with the plain search
+static double get_root_value(GoGameNN &network, GoGame &i_gogame, const int depth, const bool color) {
+    double best_move_value = -std::numeric_limits<double>::infinity();
+    i_gogame.generate_moves(color);
+    for (const GoMove &element : i_gogame.get_move_list()) {
+        i_gogame.play(element, color);
+        best_move_value = std::max(best_move_value, -scalable_go_ab_prune(
+                network, i_gogame, depth - 1, -std::numeric_limits<double>::infinity(),
+                std::numeric_limits<double>::infinity(), !color, color));
+        i_gogame.undo();
+    }
+    return best_move_value;
+}
+
+TEST(gogameab_search_check, search_matches_ab) {
+    // Validate each depth of the iterative deepening search finds the value of the plain search
+    uint8_t board_size = 5;
+    GoGame test_game(board_size);
+    GoGameNN test_network(board_size, false);
+    test_network.initialize_random();
+
+    test_game.generate_moves(0);
+    test_game.make_move(test_game.get_move_list()[7], 0);
+    GoGame original_game(test_game);
+
+    GoSearch search(test_network, 1);
+    for (int depth = 1; depth <= 3; depth++) {
+        GoSearchResult result = search.search(test_game, 1, GoSearchLimits(depth));
+        EXPECT_EQ(depth, result.depth);
+        EXPECT_NEAR(get_root_value(test_network, test_game, depth, 1), result.value, 1e-12);
+        EXPECT_GT(result.nodes, 0u);
+        EXPECT_EQ(original_game, test_game);
+    }
+}
+
+TEST(gogameab_search_check, principal_variation) {
+    // Validate the principal variation starts with the best move, and can be played out
+    uint8_t board_size = 5;
+    GoGame test_game(board_size);
+    GoGameNN test_network(board_size, false);
+    test_network.initialize_random();
+
+    GoSearch search(test_network, 1);
+    GoSearchResult result = search.search(test_game, 0, GoSearchLimits(3));
+    ASSERT_GT(result.principal_variation.size(), 0u);
+    EXPECT_LE(result.principal_variation.size(), 3u);
+    EXPECT_EQ(result.best_move, result.principal_variation[0]);
+
+    bool color = 0;
+    for (const GoMove &element : result.principal_variation) {
+        EXPECT_NO_THROW(test_game.make_move(element, color));
+        color = !color;
+    }
+}
+
+TEST(gogameab_search_check, node_limit) {
+    // Validate the search stops at the node budget, keeping the deepest completed iteration
+    uint8_t board_size = 5;
+    GoGame test_game(board_size);
+    GoGameNN test_network(board_size, false);
+    test_network.initialize_random();
+    GoGame original_game(test_game);
+
+    GoSearch search(test_network, 1);
+    GoSearchResult result = search.search(test_game, 0, GoSearchLimits(20, 500));
+    EXPECT_GE(result.depth, 1);
+    EXPECT_LT(result.depth, 20);
+    EXPECT_EQ(original_game, test_game);
+    EXPECT_NO_THROW(test_game.make_move(result.best_move, 0));
+
+    // The first iteration completes even when the budget is already spent
+    GoSearchResult first = search.search(test_game, 1, GoSearchLimits(20, 1));
+    EXPECT_EQ(1, first.depth);
+    EXPECT_NO_THROW(test_game.make_move(first.best_move, 1));
+}
+
+TEST(gogameab_search_check, ordering_counters) {
+    // Validate cut offs and table use are counted, and ordering keeps the value of the search
+    uint8_t board_size = 5;
+    GoGame test_game(board_size);
+    GoGameNN test_network(board_size, false);
+    test_network.initialize_random();
+
+    test_game.generate_moves(0);
+    test_game.make_move(test_game.get_move_list()[12], 0);
+
+    GoSearch search(test_network, 1);
+    GoSearchResult result = search.search(test_game, 1, GoSearchLimits(4));
+    EXPECT_GT(result.cutoffs, 0u);
+    EXPECT_LE(result.first_move_cutoffs, result.cutoffs);
+    EXPECT_GE(result.get_first_move_rate(), 0);
+    EXPECT_LE(result.get_first_move_rate(), 1);
+    EXPECT_GT(result.table_stats.probes, 0u);
+    EXPECT_LE(result.table_stats.hits, result.table_stats.probes);
+
+    // A second search reuses the table and history scores, and finds the same value
+    GoSearchResult repeat = search.search(test_game, 1, GoSearchLimits(4));
+    EXPECT_NEAR(result.value, repeat.value, 1e-12);
+}
+
+TEST(gogameab_search_check, threaded_search) {
+    // Validate a Lazy SMP search finds the value of the plain search, and leaves the game unchanged
+    uint8_t board_size = 5;
+    GoGame test_game(board_size);
+    GoGameNN test_network(board_size, false);
+    test_network.initialize_random();
+
+    test_game.generate_moves(0);
+    test_game.make_move(test_game.get_move_list()[7], 0);
+    GoGame original_game(test_game);
+
+    GoSearch search(test_network, 1, 4);
+    EXPECT_EQ(4u, search.get_thread_count());
+    for (int depth = 1; depth <= 3; depth++) {
+        search.clear();
+        GoSearchResult result = search.search(test_game, 1, GoSearchLimits(depth));
+        EXPECT_EQ(depth, result.depth);
+        EXPECT_NEAR(get_root_value(test_network, test_game, depth, 1), result.value, 1e-12);
+        EXPECT_EQ(result.best_move, result.principal_variation[0]);
+        EXPECT_EQ(original_game, test_game);
+    }
+
+    // Helpers stop with the main thread at a limit
+    GoSearchResult limited = search.search(test_game, 1, GoSearchLimits(20, 2000));
+    EXPECT_GE(limited.depth, 1);
+    EXPECT_LT(limited.depth, 20);
+    EXPECT_EQ(original_game, test_game);
+    EXPECT_NO_THROW(test_game.make_move(limited.best_move, 1));
+
+    // Searches started inside a parallel region run on one worker each, and find the same value
+    const double expected_value = get_root_value(test_network, original_game, 3, 1);
+    std::vector<double> nested_values(2, 0);
+    #pragma omp parallel for num_threads(2) firstprivate(test_network, original_game)
+    for (int i = 0; i < 2; i++) {
+        GoSearch nested_search(test_network, 1, 4);
+        nested_values[i] = nested_search.search(original_game, 1, GoSearchLimits(3)).value;
+    }
+    for (const double value : nested_values) {
+        EXPECT_NEAR(expected_value, value, 1e-12);
+    }
+
+    search.set_thread_count(0);
+    EXPECT_EQ(1u, search.get_thread_count());
+}
+
+TEST(gogameab_search_check, regression_suite) {
+    // Validate the principal variation search finds the value of the plain search over a set of positions, and that
+    // its best move has that value under the plain search
+    GoGameNN test_network(5, false);
+    test_network.initialize_random();
+    GoSearch search(test_network, 1);
+
+    for (unsigned int seed = 0; seed < 4; seed++) {
+        GoGame test_game(5);
+        bool color = 0;
+        for (unsigned int i = 0; i < 3 + seed; i++) {
+            test_game.generate_moves(color);
+            std::vector<GoMove> move_list = test_game.get_move_list();
+            test_game.make_move(move_list[(i * 7 + seed * 11) % (move_list.size() - 1)], color);
+            color = !color;
+        }
+
+        for (int depth = 2; depth <= 3; depth++) {
+            search.clear();
+            GoSearchResult result = search.search(test_game, color, GoSearchLimits(depth));
+            EXPECT_NEAR(get_root_value(test_network, test_game, depth, color), result.value, 1e-12);
+
+            test_game.play(result.best_move, color);
+            EXPECT_NEAR(result.value, -scalable_go_ab_prune(test_network, test_game, depth - 1,
+                                                            -std::numeric_limits<double>::infinity(),
+                                                            std::numeric_limits<double>::infinity(), !color,
+                                                            color), 1e-12);
+            test_game.undo();
+            EXPECT_GT(result.nodes, 0u);
+        }
+    }
+}
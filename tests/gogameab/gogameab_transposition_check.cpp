@@ -0,0 +1,130 @@
+// Copyright [2016] <duncan@wduncanfraser.com>
+
+#include <vector>
+#include <cstdint>
+#include <limits>
+#include "gtest/gtest.h"
+
+#include "gogame.h"
+#include "gogamenn.h"
+#include "gogameab.h"
+#include "gotranspositiontable.h"
+
+TEST(gogameab_transposition_check, store_and_probe) {
+    GoTranspositionTable table(1);
+    GoTranspositionEntry entry;
+    GoTranspositionStats stats;
+
+    EXPECT_FALSE(table.probe(12345, entry, &stats));
+    table.store(12345, 3, GoBound::lower, -0.25, 17, &stats);
+    ASSERT_TRUE(table.probe(12345, entry, &stats));
+    EXPECT_EQ(3, entry.depth);
+    EXPECT_EQ(GoBound::lower, entry.bound);
+    EXPECT_EQ(-0.25, entry.value);
+    EXPECT_EQ(17, entry.best_move);
+
+    // Storing the same key again updates it in place
+    table.store(12345, 1, GoBound::exact, 0.5, GOTT_MOVE_NONE, &stats);
+    ASSERT_TRUE(table.probe(12345, entry, &stats));
+    EXPECT_EQ(1, entry.depth);
+    EXPECT_EQ(GoBound::exact, entry.bound);
+    EXPECT_EQ(GOTT_MOVE_NONE, entry.best_move);
+
+    // A shallower bound does not replace a deeper result for the same key
+    table.store(12345, 0, GoBound::upper, 0.75, 3, &stats);
+    ASSERT_TRUE(table.probe(12345, entry, &stats));
+    EXPECT_EQ(1, entry.depth);
+    EXPECT_EQ(GoBound::exact, entry.bound);
+    EXPECT_EQ(0.5, entry.value);
+
+    EXPECT_EQ(4u, stats.probes);
+    EXPECT_EQ(3u, stats.hits);
+    EXPECT_EQ(3u, stats.stores);
+    EXPECT_EQ(0u, stats.replacements);
+
+    // Probes without stats are not counted
+    table.clear();
+    EXPECT_FALSE(table.probe(12345, entry));
+    EXPECT_EQ(4u, stats.probes);
+}
+
+TEST(gogameab_transposition_check, replacement) {
+    // Keys sharing a bucket: the deep slot keeps the deepest result of a search, the other slot takes the rest
+    GoTranspositionTable table(1);
+    uint64_t stride = table.get_size() / 64;
+    GoTranspositionEntry entry;
+    GoTranspositionStats stats;
+
+    table.store(1, 5, GoBound::exact, 0.1, 0, &stats);
+    table.store(1 + stride, 2, GoBound::exact, 0.2, 0, &stats);
+    table.store(1 + 2 * stride, 1, GoBound::exact, 0.3, 0, &stats);
+    EXPECT_TRUE(table.probe(1, entry));
+    EXPECT_FALSE(table.probe(1 + stride, entry));
+    EXPECT_TRUE(table.probe(1 + 2 * stride, entry));
+    EXPECT_EQ(1u, stats.replacements);
+
+    // A new search may replace the deep slot with a shallower result
+    table.new_search();
+    table.store(1 + 3 * stride, 0, GoBound::exact, 0.4, 0);
+    EXPECT_FALSE(table.probe(1, entry));
+    EXPECT_TRUE(table.probe(1 + 3 * stride, entry));
+}
+
+TEST(gogameab_transposition_check, size) {
+    EXPECT_THROW(GoTranspositionTable(0), GoTranspositionTableSizeError);
+
+    GoTranspositionTable table(3);
+    EXPECT_EQ(2u * 1024 * 1024, table.get_size());
+    table.resize(16);
+    EXPECT_EQ(16u * 1024 * 1024, table.get_size());
+}
+
+TEST(gogameab_transposition_check, search_key) {
+    // The key depends on the side to move and the perspective as well as the board
+    GoGame test_game(5);
+    uint64_t key = get_search_key(test_game, 0, 0);
+    EXPECT_NE(key, get_search_key(test_game, 1, 0));
+    EXPECT_NE(key, get_search_key(test_game, 0, 1));
+
+    test_game.generate_moves(0);
+    test_game.play(test_game.get_move_list()[3], 0);
+    EXPECT_NE(key, get_search_key(test_game, 0, 0));
+    test_game.undo();
+    EXPECT_EQ(key, get_search_key(test_game, 0, 0));
+
+    // The empty board does not match the empty slots of a cleared table
+    GoTranspositionTable table(1);
+    GoTranspositionEntry entry;
+    EXPECT_NE(0u, key);
+    EXPECT_FALSE(table.probe(key, entry));
+}
+
+TEST(gogameab_transposition_check, ab_table_matches) {
+    // Validate the search with a transposition table matches the plain search, and hits on transpositions
+    uint8_t board_size = 5;
+    GoGame test_game(board_size);
+    GoGameNN test_network(board_size, false);
+    test_network.initialize_random();
+
+    test_game.generate_moves(0);
+    test_game.make_move(test_game.get_move_list()[7], 0);
+    GoGame original_game(test_game);
+
+    GoTranspositionTable table(1);
+    GoTranspositionStats stats;
+    for (int depth = 1; depth <= 3; depth++) {
+        double expected = -scalable_go_ab_prune(test_network, test_game, depth,
+                                                -std::numeric_limits<double>::infinity(),
+                                                std::numeric_limits<double>::infinity(), 1, 0);
+
+        table.new_search();
+        EXPECT_NEAR(expected, -scalable_go_ab_prune(test_network, test_game, depth,
+                                                    -std::numeric_limits<double>::infinity(),
+                                                    std::numeric_limits<double>::infinity(), 1, 0, table, &stats),
+                    1e-12);
+        EXPECT_EQ(original_game, test_game);
+    }
+
+    EXPECT_GT(stats.hits, 0u);
+    EXPECT_GT(stats.get_hit_rate(), 0);
+}
@@ -1,6 +1,7 @@
 // Copyright [2016] <duncan@wduncanfraser.com>
 
 #include <vector>
+#include <algorithm>
 #include <cstdint>
 #include <iostream>
 #include <string>
@@ -346,6 +347,39 @@ TEST(gogamenn_basic_check, write_multiple_to_file) {
     EXPECT_EQ(test_networks1, test_networks2);
 }
 
+TEST(gogamenn_basic_check, write_multiple_to_binary_file) {
+    // Check that networks come back unchanged from a binary weight file, and that import_go_networks reads both
+    // formats
+    std::vector<GoGameNN> test_networks1(3, GoGameNN(5, false));
+    for (GoGameNN &element : test_networks1) {
+        element.initialize_random();
+    }
+
+    NeuralNetWeightFileWriter writer("testgogamenns.bin");
+    std::ofstream output_file("testgogamenns.txt");
+    for (GoGameNN &element : test_networks1) {
+        element.export_weights_binary(writer);
+        element.export_weights_stream(output_file);
+    }
+    writer.close();
+    output_file.close();
+
+    std::vector<GoGameNN> test_networks2(3, GoGameNN(5, false));
+    import_go_networks(test_networks2, 3, "testgogamenns.bin");
+    EXPECT_EQ(test_networks1, test_networks2);
+    EXPECT_EQ("testgogamenns.bin", get_go_networks_path("testgogamenns"));
+
+    std::vector<GoGameNN> test_networks3(3, GoGameNN(5, false));
+    import_go_networks(test_networks3, 3, "testgogamenns.txt");
+    EXPECT_EQ(test_networks1, test_networks3);
+
+    // Borrowed networks evaluate the same as owned ones
+    GoGame test_game(5);
+    test_networks1[0].feed_forward(test_game, 0);
+    test_networks2[0].feed_forward(test_game, 0);
+    EXPECT_EQ(test_networks1[0].get_output(), test_networks2[0].get_output());
+}
+
 TEST(gogamenn_basic_check, write_multiple_to_file_uniform) {
     // Check that there is no data loss/roundng error in exporting networks to file
     std::vector<GoGameNN> test_networks1(10, GoGameNN(5, true));
@@ -370,3 +404,188 @@ TEST(gogamenn_basic_check, write_multiple_to_file_uniform) {
 
     EXPECT_EQ(test_networks1, test_networks2);
 }
+
+// Function to check feed_forward_batch against feed_forward over the positions after each opening move
+static void check_batch_feed_forward(const bool uniform) {
+    uint8_t board_size = 5;
+    GoGameNN test_nn(board_size, uniform);
+    test_nn.initialize_random();
+
+    GoGame test_game(board_size);
+    test_game.generate_moves(0);
+    std::vector<GoGameNNInput> inputs;
+    std::vector<double> expected;
+    for (const GoMove &element : test_game.get_move_list()) {
+        test_game.play(element, 0);
+        inputs.push_back(get_go_network_input(test_game, 1));
+        test_nn.feed_forward(inputs.back().segments, inputs.back().pieces_played, inputs.back().prisoner_count,
+                             inputs.back().opponent_prisoner_count);
+        expected.push_back(test_nn.get_output());
+        test_game.undo();
+    }
+
+    test_nn.feed_forward_batch(inputs);
+    ASSERT_EQ(expected.size(), test_nn.get_batch_output().size());
+    for (size_t i = 0; i < expected.size(); i++) {
+        EXPECT_NEAR(expected[i], test_nn.get_batch_output()[i], 1e-12);
+    }
+}
+
+TEST(gogamenn_basic_check, gogamenn_5x5_batch) {
+    check_batch_feed_forward(false);
+}
+
+TEST(gogamenn_basic_check, gogamenn_5x5_batch_uniform) {
+    check_batch_feed_forward(true);
+}
+
+TEST(gogamenn_basic_check, gogamenn_5x5_uniform_matches_expanded) {
+    // Validate the batched uniform layer 1 against a non uniform network holding a copy of the shared network for
+    // every window, which is fed forward one window at a time
+    uint8_t board_size = 5;
+    GoGameNN uniform_nn(board_size, true);
+    uniform_nn.initialize_random();
+
+    std::ofstream output_file("testgogamenn_expanded.txt");
+    uniform_nn.export_weights_stream(output_file);
+    output_file.close();
+
+    // Each network is exported as 3 lines. Repeat each layer 1 network once per window.
+    std::ifstream uniform_file("testgogamenn_expanded.txt");
+    std::vector<std::string> lines;
+    std::string line;
+    while (getline(uniform_file, line)) {
+        lines.push_back(line);
+    }
+    uniform_file.close();
+
+    std::vector<uint8_t> segments = get_go_board_segments(board_size);
+    std::ofstream expanded_file("testgogamenn_expanded.txt");
+    for (size_t j = 0; j < segments.size(); j++) {
+        for (int k = 0; k < (board_size - segments[j] + 1) * (board_size - segments[j] + 1); k++) {
+            expanded_file << lines[j * 3] << "\n" << lines[j * 3 + 1] << "\n" << lines[j * 3 + 2] << "\n";
+        }
+    }
+    expanded_file << lines[segments.size() * 3] << "\n" << lines[segments.size() * 3 + 1] << "\n"
+                  << lines[segments.size() * 3 + 2] << "\n";
+    expanded_file.close();
+
+    GoGameNN expanded_nn(board_size, false);
+    std::ifstream input_file("testgogamenn_expanded.txt");
+    expanded_nn.import_weights_stream(input_file);
+    input_file.close();
+
+    GoGame test_game(board_size);
+    test_game.generate_moves(0);
+    test_game.make_move(test_game.get_move_list()[6], 0);
+    test_game.generate_moves(1);
+    test_game.make_move(test_game.get_move_list()[12], 1);
+
+    GoGameNNInput input = get_go_network_input(test_game, 0);
+    uniform_nn.feed_forward(input.segments, input.pieces_played, input.prisoner_count, input.opponent_prisoner_count);
+    expanded_nn.feed_forward(input.segments, input.pieces_played, input.prisoner_count, input.opponent_prisoner_count);
+
+    EXPECT_NEAR(expanded_nn.get_output(), uniform_nn.get_output(), 1e-12);
+}
+
+TEST(gogamenn_basic_check, flat_translation_matches) {
+    // Validate the flat translation holds the same values as the nested translation, with bias and zero padding
+    uint8_t board_size = 7;
+    GoGame test_game(board_size);
+    test_game.generate_moves(0);
+    test_game.make_move(test_game.get_move_list()[10], 0);
+    test_game.generate_moves(1);
+    test_game.make_move(test_game.get_move_list()[30], 1);
+
+    const GoGameNNLayout &layout = get_go_network_layout(board_size);
+    NeuralNetBuffer<double> translation(layout.length);
+    get_go_network_translation(test_game, 1, translation.get());
+    std::vector<std::vector<double>> expected = get_go_network_translation(test_game, 1);
+
+    ASSERT_EQ(expected.size(), layout.window_offsets.size());
+    for (size_t j = 0; j < layout.segments.size(); j++) {
+        for (uint16_t k = 0; k < layout.segment_counts[j]; k++) {
+            uint16_t window = uint16_t(layout.first_windows[j] + k);
+            const double *output = translation.get() + layout.window_offsets[window];
+            EXPECT_TRUE(std::equal(expected[window].begin(), expected[window].end(), output));
+            EXPECT_EQ(1.0, output[expected[window].size()]);
+            for (size_t i = expected[window].size() + 1; i < layout.strides[j]; i++) {
+                EXPECT_EQ(0.0, output[i]);
+            }
+        }
+    }
+}
+
+TEST(gogamenn_basic_check, flat_translation_matches_all_sizes) {
+    // Validate every window of every board size is fully written, including stones on the last row and column,
+    // which the sliding extractor copies past
+    for (uint8_t board_size = SEGMENT_MIN; board_size <= SEGMENT_MAX; board_size += SEGMENT_DIVISION) {
+        GoGame test_game(board_size);
+        test_game.generate_moves(0);
+        test_game.make_move(test_game.get_move_list()[board_size * board_size - 1], 0);
+        test_game.generate_moves(1);
+        test_game.make_move(test_game.get_move_list()[board_size - 1], 1);
+        test_game.generate_moves(0);
+        test_game.make_move(test_game.get_move_list()[board_size * (board_size - 1) / 2], 0);
+
+        const GoGameNNLayout &layout = get_go_network_layout(board_size);
+        NeuralNetBuffer<double> translation(layout.length);
+        std::fill(translation.get(), translation.get() + layout.length, 2.0);
+        get_go_network_translation(test_game, 0, translation.get());
+        std::vector<std::vector<double>> expected = get_go_network_translation(test_game, 0);
+
+        ASSERT_EQ(expected.size(), layout.window_offsets.size());
+        for (size_t j = 0; j < layout.segments.size(); j++) {
+            for (uint16_t k = 0; k < layout.segment_counts[j]; k++) {
+                uint16_t window = uint16_t(layout.first_windows[j] + k);
+                const double *output = translation.get() + layout.window_offsets[window];
+                EXPECT_TRUE(std::equal(expected[window].begin(), expected[window].end(), output));
+                EXPECT_EQ(1.0, output[expected[window].size()]);
+                for (size_t i = expected[window].size() + 1; i < layout.strides[j]; i++) {
+                    EXPECT_EQ(0.0, output[i]);
+                }
+            }
+        }
+    }
+}
+
+// Function to check the GoGame and GoGameNNBatch evaluation paths against nested translations
+static void check_flat_feed_forward(const bool uniform) {
+    uint8_t board_size = 5;
+    GoGameNN test_nn(board_size, uniform);
+    test_nn.initialize_random();
+
+    GoGame test_game(board_size);
+    test_game.generate_moves(0);
+    test_game.make_move(test_game.get_move_list()[3], 0);
+
+    GoGameNNBatch batch(board_size);
+    std::vector<double> expected;
+    test_game.generate_moves(1);
+    for (const GoMove &element : test_game.get_move_list()) {
+        test_game.play(element, 1);
+        test_nn.feed_forward(get_go_network_translation(test_game, 0), test_game.get_pieces_placed()[0],
+                             test_game.get_prisoner_count()[0], test_game.get_prisoner_count()[1]);
+        expected.push_back(test_nn.get_output());
+
+        test_nn.feed_forward(test_game, 0);
+        EXPECT_NEAR(expected.back(), test_nn.get_output(), 1e-12);
+
+        batch.add_position(test_game, 0);
+        test_game.undo();
+    }
+
+    test_nn.feed_forward_batch(batch);
+    ASSERT_EQ(expected.size(), test_nn.get_batch_output().size());
+    for (size_t i = 0; i < expected.size(); i++) {
+        EXPECT_NEAR(expected[i], test_nn.get_batch_output()[i], 1e-12);
+    }
+}
+
+TEST(gogamenn_basic_check, gogamenn_5x5_flat_feed_forward) {
+    check_flat_feed_forward(false);
+}
+
+TEST(gogamenn_basic_check, gogamenn_5x5_flat_feed_forward_uniform) {
+    check_flat_feed_forward(true);
+}
@@ -0,0 +1,95 @@
+// Copyright [2016] <duncan@wduncanfraser.com>
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include "gtest/gtest.h"
+
+#include "gogame.h"
+#include "gogamenn.h"
+#include "gogamennevaluator.h"
+
+// Function to get the full feed_forward output of i_gogame, for comparison with the evaluator
+static double get_full_output(GoGameNN &network, const GoGame &i_gogame, const bool color) {
+    network.feed_forward(get_go_network_translation(i_gogame, color), i_gogame.get_pieces_placed()[color],
+                         i_gogame.get_prisoner_count()[color], i_gogame.get_prisoner_count()[!color]);
+    return network.get_output();
+}
+
+// Function to play a random game, checking the evaluator against a full evaluation after every move
+static void check_random_game(const uint8_t board_size, const bool uniform) {
+    GoGameNN test_network(board_size, uniform);
+    test_network.initialize_random();
+    GoGame test_game(board_size);
+    GoGameNNEvaluator evaluator(test_network, test_game, 0);
+    std::mt19937 generator(2016);
+    NeuralNetBuffer<double> expected_translation(get_go_network_layout(board_size).length);
+
+    bool color = 0;
+    // Long enough on a small board for captures
+    for (unsigned int i = 0; i < 60; i++) {
+        test_game.generate_moves(color);
+        std::vector<GoMove> move_list = test_game.get_move_list();
+        std::uniform_int_distribution<size_t> distribution(0, move_list.size() - 1);
+        test_game.make_move(move_list[distribution(generator)], color);
+        color = !color;
+
+        evaluator.update();
+        get_go_network_translation(test_game, 0, expected_translation.get());
+        ASSERT_TRUE(std::equal(expected_translation.get(), expected_translation.get() + expected_translation.size(),
+                               evaluator.get_translation()));
+        EXPECT_NEAR(get_full_output(test_network, test_game, 0), evaluator.evaluate(), 1e-12);
+    }
+}
+
+TEST(gogamenn_evaluator_check, random_game_matches_full) {
+    check_random_game(5, false);
+}
+
+TEST(gogamenn_evaluator_check, random_game_matches_full_uniform) {
+    check_random_game(5, true);
+}
+
+TEST(gogamenn_evaluator_check, rollback_restores) {
+    uint8_t board_size = 5;
+    GoGameNN test_network(board_size, false);
+    test_network.initialize_random();
+    GoGame test_game(board_size);
+    GoGameNNEvaluator evaluator(test_network, test_game, 1);
+
+    test_game.generate_moves(0);
+    test_game.make_move(test_game.get_move_list()[12], 0);
+    evaluator.update();
+    size_t length = get_go_network_layout(board_size).length;
+    std::vector<double> expected_translation(evaluator.get_translation(), evaluator.get_translation() + length);
+    double expected_output = evaluator.evaluate();
+
+    // Search two moves deep, taking each back
+    test_game.generate_moves(1);
+    for (const GoMove &element : test_game.get_move_list()) {
+        test_game.play(element, 1);
+        evaluator.update();
+        test_game.generate_moves(0);
+        for (const GoMove &reply : test_game.get_move_list()) {
+            test_game.play(reply, 0);
+            evaluator.update();
+            EXPECT_NEAR(get_full_output(test_network, test_game, 1), evaluator.evaluate(), 1e-12);
+            test_game.undo();
+            evaluator.rollback();
+        }
+        test_game.undo();
+        evaluator.rollback();
+    }
+
+    EXPECT_TRUE(std::equal(expected_translation.begin(), expected_translation.end(), evaluator.get_translation()));
+    EXPECT_EQ(expected_output, evaluator.evaluate());
+}
+
+TEST(gogamenn_evaluator_check, bad_rollback) {
+    GoGameNN test_network(5, true);
+    GoGame test_game(5);
+    GoGameNNEvaluator evaluator(test_network, test_game, 0);
+
+    EXPECT_THROW(evaluator.rollback(), GoGameNNEvaluatorRollbackError);
+}
@@ -3,6 +3,8 @@
 #include <vector>
 #include <iostream>
 #include <fstream>
+#include <sstream>
+#include <string>
 #include "gtest/gtest.h"
 
 #include "neuralnet.h"
@@ -63,6 +65,65 @@ TEST(neuralnet_basic_check, mutator_output) {
     EXPECT_NE(test1.get_output(), test2.get_output());
 }
 
+TEST(neuralnet_basic_check, copy_shares_weights) {
+    // Check that copies share weights until one is modified, and that modifying a copy leaves the others unchanged
+    NeuralNet test1(LAYERS, {INPUT, HL1, HL2, OUTPUT});
+    test1.initialize_random();
+    EXPECT_FALSE(test1.check_weights_shared());
+
+    NeuralNet test2(test1);
+    NeuralNet test3(LAYERS, {INPUT, HL1, HL2, OUTPUT});
+    test3 = test1;
+    EXPECT_TRUE(test1.check_weights_shared());
+    EXPECT_TRUE(test2.check_weights_shared());
+
+    test2.mutate(MUTATER);
+    EXPECT_FALSE(test2.check_weights_shared());
+    EXPECT_NE(test1, test2);
+    EXPECT_EQ(test1, test3);
+
+    // Copies evaluate independently, with their own neurons
+    std::vector<double> test_input(INPUT, 0.5);
+    test1.feed_forward(test_input);
+    test3.feed_forward(std::vector<double>(INPUT, -0.5));
+    NeuralNet test4(LAYERS, {INPUT, HL1, HL2, OUTPUT});
+    test4 = test1;
+    test4.feed_forward(test_input);
+    EXPECT_EQ(test4.get_output(), test1.get_output());
+    EXPECT_NE(test3.get_output(), test1.get_output());
+}
+
+TEST(neuralnet_basic_check, parallel_copies_mutate_independently) {
+    // Copy and mutate one network from several threads at once, as the training loop does. Mutating any network,
+    // including the one copied from, must leave every other network unchanged.
+    NeuralNet source(LAYERS, {INPUT, HL1, HL2, OUTPUT});
+    source.initialize_random();
+    const NeuralNet reference(source);
+    std::vector<NeuralNet> copies(8, NeuralNet(LAYERS, {INPUT, HL1, HL2, OUTPUT}));
+
+    #pragma omp parallel for
+    for (unsigned int i = 0; i < copies.size(); i++) {
+        NeuralNet copy(source);
+        copy.mutate(MUTATER);
+        copies[i] = copy;
+    }
+
+    EXPECT_EQ(reference, source);
+    for (const NeuralNet &element : copies) {
+        EXPECT_NE(reference, element);
+    }
+
+    // The reference still shares the weights of source, and keeps its output when source is mutated
+    NeuralNet shared_reference(reference);
+    std::vector<double> test_input(INPUT, 0.5);
+    shared_reference.feed_forward(test_input);
+    std::vector<double> reference_output = shared_reference.get_output();
+    source.mutate(MUTATER);
+    shared_reference.feed_forward(test_input);
+    EXPECT_EQ(reference_output, shared_reference.get_output());
+    EXPECT_NE(reference, source);
+}
+
 TEST(neuralnet_basic_check, write_to_file) {
     // Check that there is no data loss/roundng error in exporting the network to file
     NeuralNet test1(LAYERS, {INPUT, HL1, HL2, OUTPUT});
@@ -79,3 +140,47 @@ TEST(neuralnet_basic_check, write_to_file) {
 
     EXPECT_EQ(test1, test2);
 }
+
+TEST(neuralnet_basic_check, feed_forward_reference) {
+    // Check feed_forward against a direct calculation from the exported weights
+    std::vector<unsigned int> neuron_counts = {INPUT, HL1, HL2, OUTPUT};
+    NeuralNet test1(LAYERS, neuron_counts);
+    test1.initialize_random();
+
+    std::ofstream output_file("testweights_reference.txt");
+    test1.export_weights_stream(output_file);
+    output_file.close();
+
+    // Skip the layer count and neuron count lines, and read the weights
+    std::ifstream input_file("testweights_reference.txt");
+    std::string line, element;
+    getline(input_file, line);
+    getline(input_file, line);
+    getline(input_file, line);
+    input_file.close();
+    std::istringstream weight_stream(line);
+
+    std::vector<double> neurons = {1, 1, 1, 0, 1, 0, 1, 1, 0, 1, 1, 1, 1, 0, 0, 0, 0, -1, 0, 0, -1, -1, -1, 0, -1, -1,
+                                   -1, -1, 0, -1, -1, -1};
+    test1.feed_forward(neurons);
+
+    for (unsigned int i = 1; i < LAYERS; i++) {
+        // Append bias
+        neurons.push_back(1.0);
+        std::vector<double> next(neuron_counts[i], 0);
+        for (double &neuron : next) {
+            for (double previous : neurons) {
+                getline(weight_stream, element, ',');
+                DoubleInt converter;
+                converter.i = std::stoll(element);
+                neuron += previous * converter.d;
+            }
+            neuron = activate(neuron);
+        }
+        neurons = next;
+    }
+
+    ASSERT_EQ(neurons.size(), test1.get_output().size());
+    // Vector kernels may sum in a different order
+    EXPECT_NEAR(neurons[0], test1.get_output()[0], 1e-12);
+}
@@ -0,0 +1,128 @@
+// Copyright [2016] <duncan@wduncanfraser.com>
+
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <string>
+#include "gtest/gtest.h"
+
+#include "neuralnet.h"
+#include "neuralnetfile.h"
+
+#define LAYERS 4
+#define INPUT 32
+#define HL1 40
+#define HL2 10
+#define OUTPUT 1
+#define MUTATER 0.01
+
+// Function to write networks to a binary weight file at path
+static void write_weight_file(const std::string &path, const std::vector<NeuralNet> &networks) {
+    NeuralNetWeightFileWriter writer(path);
+    for (const NeuralNet &network : networks) {
+        network.export_weights_binary(writer);
+    }
+    writer.close();
+}
+
+TEST(neuralnet_file_check, write_to_binary_file) {
+    // Check that networks of different topologies and precisions come back unchanged, and borrow their weights
+    std::vector<NeuralNet> networks = {NeuralNet(LAYERS, {INPUT, HL1, HL2, OUTPUT}), NeuralNet(3, {7, 5, 2})};
+    for (NeuralNet &network : networks) {
+        network.initialize_random();
+    }
+    networks[1].set_precision(NeuralNetPrecision::int8);
+    write_weight_file("testweights.bin", networks);
+
+    EXPECT_TRUE(check_weight_file("testweights.bin"));
+    std::shared_ptr<const NeuralNetWeightFile> file = std::make_shared<const NeuralNetWeightFile>("testweights.bin");
+    ASSERT_EQ(2u, file->get_network_count());
+
+    NeuralNet test1(LAYERS, {INPUT, HL1, HL2, OUTPUT});
+    NeuralNet test2(3, {7, 5, 2});
+    size_t index = 0;
+    test1.import_weights_binary(file, index);
+    test2.import_weights_binary(file, index);
+    EXPECT_EQ(2u, index);
+
+    EXPECT_EQ(networks[0], test1);
+    EXPECT_EQ(networks[1], test2);
+    EXPECT_TRUE(test1.check_weights_borrowed());
+    EXPECT_EQ(NeuralNetPrecision::fp64, test1.get_precision());
+    EXPECT_EQ(NeuralNetPrecision::int8, test2.get_precision());
+
+    // Borrowed weights evaluate the same as owned ones
+    std::vector<double> test_input(INPUT, 0.5);
+    networks[0].feed_forward(test_input);
+    test1.feed_forward(test_input);
+    EXPECT_EQ(networks[0].get_output(), test1.get_output());
+}
+
+TEST(neuralnet_file_check, text_file_is_not_binary) {
+    NeuralNet test1(LAYERS, {INPUT, HL1, HL2, OUTPUT});
+    test1.initialize_random();
+
+    std::ofstream output_file("testweights.txt");
+    test1.export_weights_stream(output_file);
+    output_file.close();
+
+    EXPECT_FALSE(check_weight_file("testweights.txt"));
+    EXPECT_FALSE(check_weight_file("testweights_missing.bin"));
+    EXPECT_THROW(NeuralNetWeightFile("testweights.txt"), NeuralNetImportError);
+}
+
+TEST(neuralnet_file_check, borrowed_copy_on_write) {
+    // Check that mutating a borrowed network copies its weights, leaving the file and other borrowers unchanged
+    NeuralNet original(LAYERS, {INPUT, HL1, HL2, OUTPUT});
+    original.initialize_random();
+    write_weight_file("testweights.bin", {original});
+
+    std::shared_ptr<const NeuralNetWeightFile> file = std::make_shared<const NeuralNetWeightFile>("testweights.bin");
+    NeuralNet test1(LAYERS, {INPUT, HL1, HL2, OUTPUT});
+    size_t index = 0;
+    test1.import_weights_binary(file, index);
+
+    // Copies share the borrowed weights
+    NeuralNet test2(test1);
+    EXPECT_TRUE(test2.check_weights_borrowed());
+
+    test2.mutate(MUTATER);
+    EXPECT_FALSE(test2.check_weights_borrowed());
+    EXPECT_NE(original, test2);
+    EXPECT_TRUE(test1.check_weights_borrowed());
+    EXPECT_EQ(original, test1);
+
+    // Networks keep the file mapped after it is released
+    file.reset();
+    EXPECT_EQ(original, test1);
+}
+
+TEST(neuralnet_file_check, binary_topology_mismatch) {
+    NeuralNet test1(LAYERS, {INPUT, HL1, HL2, OUTPUT});
+    test1.initialize_random();
+    write_weight_file("testweights.bin", {test1});
+
+    std::shared_ptr<const NeuralNetWeightFile> file = std::make_shared<const NeuralNetWeightFile>("testweights.bin");
+    NeuralNet test2(LAYERS, {INPUT, HL1, HL2 + 1, OUTPUT});
+    size_t index = 0;
+    EXPECT_THROW(test2.import_weights_binary(file, index), NeuralNetImportError);
+
+    // Reading past the last network
+    index = 1;
+    EXPECT_THROW(test1.import_weights_binary(file, index), NeuralNetImportError);
+}
+
+TEST(neuralnet_file_check, binary_checksum) {
+    // Check that a corrupted weight is caught by the checksum, unless verification is skipped
+    NeuralNet test1(LAYERS, {INPUT, HL1, HL2, OUTPUT});
+    test1.initialize_random();
+    write_weight_file("testweights.bin", {test1});
+
+    std::fstream file("testweights.bin", std::fstream::in | std::fstream::out | std::fstream::binary);
+    file.seekp(-NEURALNET_ALIGNMENT * 2, std::fstream::end);
+    file.put(char(0x55));
+    file.close();
+
+    EXPECT_THROW(NeuralNetWeightFile("testweights.bin"), NeuralNetImportError);
+    EXPECT_NO_THROW(NeuralNetWeightFile("testweights.bin", false));
+}
@@ -0,0 +1,98 @@
+// Copyright [2016] <duncan@wduncanfraser.com>
+
+#include <vector>
+#include <random>
+#include "gtest/gtest.h"
+
+#include "neuralnet.h"
+#include "neuralnetkernels.h"
+
+#define KERNEL_TOLERANCE 1e-12
+
+TEST(neuralnet_kernel_check, scalar_supported) {
+    std::vector<NeuralNetKernel> kernels = get_supported_kernels();
+    ASSERT_FALSE(kernels.empty());
+    EXPECT_EQ(NeuralNetKernel::scalar, kernels.front());
+    EXPECT_TRUE(check_kernel_supported(get_active_kernel()));
+}
+
+TEST(neuralnet_kernel_check, kernels_match_scalar) {
+    // Check every supported kernel against the scalar reference, with layer sizes that leave partial blocks
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+    NeuralNetKernel original_kernel = get_active_kernel();
+
+    for (std::vector<unsigned int> neuron_counts : std::vector<std::vector<unsigned int>>
+            {{32, 40, 10, 1}, {9, 5, 3}, {82, 19, 7, 2}, {7, 16, 17}}) {
+        NeuralNet test_network(unsigned(neuron_counts.size()), neuron_counts);
+        test_network.initialize_random();
+
+        std::vector<double> input(neuron_counts[0]);
+        for (double &element : input) {
+            element = distribution(generator);
+        }
+
+        set_active_kernel(NeuralNetKernel::scalar);
+        test_network.feed_forward(input);
+        std::vector<double> expected = test_network.get_output();
+
+        for (NeuralNetKernel kernel : get_supported_kernels()) {
+            set_active_kernel(kernel);
+            test_network.feed_forward(input);
+            std::vector<double> output = test_network.get_output();
+
+            ASSERT_EQ(expected.size(), output.size());
+            for (size_t i = 0; i < expected.size(); i++) {
+                EXPECT_NEAR(expected[i], output[i], KERNEL_TOLERANCE) << get_kernel_name(kernel);
+            }
+        }
+    }
+
+    set_active_kernel(original_kernel);
+}
+
+TEST(neuralnet_kernel_check, batch_matches_feed_forward) {
+    // Check the batch kernels against feed_forward, with batch sizes that leave partial register blocks
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+    NeuralNetKernel original_kernel = get_active_kernel();
+
+    for (std::vector<unsigned int> neuron_counts : std::vector<std::vector<unsigned int>>
+            {{32, 40, 10, 1}, {9, 5, 3}, {82, 19, 7, 2}}) {
+        NeuralNet test_network(unsigned(neuron_counts.size()), neuron_counts);
+        test_network.initialize_random();
+
+        for (size_t batch_size : {1, 2, 5, 8}) {
+            std::vector<std::vector<double>> inputs(batch_size, std::vector<double>(neuron_counts[0]));
+            for (std::vector<double> &input : inputs) {
+                for (double &element : input) {
+                    element = distribution(generator);
+                }
+            }
+
+            for (NeuralNetKernel kernel : get_supported_kernels()) {
+                set_active_kernel(kernel);
+                test_network.feed_forward_batch(inputs);
+
+                for (size_t b = 0; b < batch_size; b++) {
+                    NeuralNet single_network(test_network);
+                    single_network.feed_forward(inputs[b]);
+                    std::vector<double> expected = single_network.get_output();
+                    for (size_t i = 0; i < expected.size(); i++) {
+                        EXPECT_NEAR(expected[i], test_network.get_batch_output(b)[i], KERNEL_TOLERANCE)
+                                            << get_kernel_name(kernel);
+                    }
+                }
+            }
+        }
+    }
+
+    set_active_kernel(original_kernel);
+}
+
+TEST(neuralnet_kernel_check, bad_batch_feed_forward) {
+    NeuralNet test_network(3, {9, 5, 3});
+    std::vector<std::vector<double>> inputs {std::vector<double>(9, 0), std::vector<double>(8, 0)};
+
+    EXPECT_THROW(test_network.feed_forward_batch(inputs), NeuralNetFeedForwardError);
+}
@@ -0,0 +1,88 @@
+// Copyright [2016] <duncan@wduncanfraser.com>
+
+#include <vector>
+#include <random>
+#include "gtest/gtest.h"
+
+#include "neuralnet.h"
+#include "neuralnetkernels.h"
+
+#define FP32_TOLERANCE 1e-4
+#define INT8_TOLERANCE 5e-2
+
+// Function to feed input forward at precision on every supported kernel, and check against the fp64 output
+static void check_precision(NeuralNet &test_network, const std::vector<double> &input,
+                            const NeuralNetPrecision precision, const double tolerance) {
+    NeuralNetKernel original_kernel = get_active_kernel();
+
+    test_network.set_precision(NeuralNetPrecision::fp64);
+    test_network.feed_forward(input);
+    std::vector<double> expected = test_network.get_output();
+
+    test_network.set_precision(precision);
+    for (NeuralNetKernel kernel : get_supported_kernels()) {
+        set_active_kernel(kernel);
+        test_network.feed_forward(input);
+        std::vector<double> output = test_network.get_output();
+
+        ASSERT_EQ(expected.size(), output.size());
+        for (size_t i = 0; i < expected.size(); i++) {
+            EXPECT_NEAR(expected[i], output[i], tolerance) << get_kernel_name(kernel);
+        }
+    }
+
+    set_active_kernel(original_kernel);
+}
+
+TEST(neuralnet_precision_check, reduced_precision_matches_fp64) {
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+
+    for (std::vector<unsigned int> neuron_counts : std::vector<std::vector<unsigned int>>
+            {{32, 40, 10, 1}, {9, 5, 3}, {82, 19, 7, 2}, {7, 16, 17}}) {
+        NeuralNet test_network(unsigned(neuron_counts.size()), neuron_counts);
+        test_network.initialize_random();
+
+        std::vector<double> input(neuron_counts[0]);
+        for (double &element : input) {
+            element = distribution(generator);
+        }
+
+        check_precision(test_network, input, NeuralNetPrecision::fp32, FP32_TOLERANCE);
+        check_precision(test_network, input, NeuralNetPrecision::int8, INT8_TOLERANCE);
+    }
+}
+
+TEST(neuralnet_precision_check, mutate_rebuilds_weights) {
+    NeuralNet test_network(3, {9, 5, 3});
+    test_network.initialize_random();
+    std::vector<double> input(9, 0.5);
+
+    // Build the reduced precision weights, then change the master weights
+    test_network.set_precision(NeuralNetPrecision::fp32);
+    test_network.feed_forward(input);
+    test_network.mutate(0.5);
+
+    check_precision(test_network, input, NeuralNetPrecision::fp32, FP32_TOLERANCE);
+}
+
+TEST(neuralnet_precision_check, copy_keeps_precision) {
+    NeuralNet test_network(3, {9, 5, 3});
+    test_network.initialize_random();
+    test_network.set_precision(NeuralNetPrecision::int8);
+    std::vector<double> input(9, -0.25);
+    test_network.feed_forward(input);
+
+    NeuralNet test_copy(test_network);
+    NeuralNet test_assign;
+    test_assign = test_network;
+    EXPECT_EQ(NeuralNetPrecision::int8, test_copy.get_precision());
+    EXPECT_EQ(NeuralNetPrecision::int8, test_assign.get_precision());
+    EXPECT_EQ(NeuralNetPrecision::fp64, NeuralNet(3, {9, 5, 3}).get_precision());
+
+    // Copies feed forward to the same output
+    test_copy.feed_forward(input);
+    test_assign.feed_forward(input);
+    EXPECT_EQ(test_network.get_output(), test_copy.get_output());
+    EXPECT_EQ(test_network.get_output(), test_assign.get_output());
+}